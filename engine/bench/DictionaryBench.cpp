@@ -0,0 +1,38 @@
+/**
+ * Note: benchmarks of NextDictionary
+ * Date: 2026/10/18
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "NextDictionary.h"
+
+// options and stats are read back by name, e.g. on every message
+static void BM_DictionaryFindInt64(benchmark::State &state) {
+    NextDictionary dict;
+    int count = static_cast<int>(state.range(0));
+    for (int i = 0; i < count; i++) {
+        dict.SetInt64(("key_" + std::to_string(i)).c_str(), i);
+    }
+    std::string last = "key_" + std::to_string(count - 1);
+    for (auto _ : state) {
+        int64_t value = 0;
+        benchmark::DoNotOptimize(dict.FindInt64(last.c_str(), &value));
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_DictionaryFindInt64)->Arg(8)->Arg(64);
+
+static void BM_DictionarySet(benchmark::State &state) {
+    for (auto _ : state) {
+        NextDictionary dict;
+        dict.SetInt64("width", 1920);
+        dict.SetInt64("height", 1080);
+        dict.SetInt64("bit_rate", 8000000);
+        dict.SetString("codec", "h264");
+        benchmark::DoNotOptimize(dict.GetSize());
+    }
+}
+BENCHMARK(BM_DictionarySet);
@@ -0,0 +1,111 @@
+/**
+ * Note: benchmarks of MediaClock under concurrent readers and writers
+ * Date: 2026/10/18
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+#include "MediaClock.h"
+
+// the writer alternates between two far apart pts, any read far from both is torn
+#define BENCH_PTS_A 1000.0
+#define BENCH_PTS_B 2000.0
+
+static MediaClock sClock;
+static std::atomic_bool sStopWriter {false};
+static std::thread sWriter;
+
+// the audio thread updating the clock as fast as it can
+static void StartWriter(const benchmark::State &) {
+    sClock.SetPause(false);
+    sClock.SetSpeed(0.5);
+    sClock.SetClock(BENCH_PTS_A);
+    sStopWriter = false;
+    sWriter = std::thread([] {
+        int serial = 0;
+        while (!sStopWriter) {
+            sClock.SetClock(serial % 2 ? BENCH_PTS_B : BENCH_PTS_A);
+            sClock.SetClockSerial(serial++);
+        }
+    });
+}
+
+static void StopWriter(const benchmark::State &) {
+    sStopWriter = true;
+    sWriter.join();
+}
+
+static bool IsTorn(double clock) {
+    return !(std::fabs(clock - BENCH_PTS_A) < 1.0 || std::fabs(clock - BENCH_PTS_B) < 1.0);
+}
+
+// render, audio and message threads polling the clock
+static void BM_MediaClockRead(benchmark::State &state) {
+    int64_t torn = 0;
+    for (auto _ : state) {
+        double clock = sClock.GetClock();
+        torn += IsTorn(clock) ? 1 : 0;
+        benchmark::DoNotOptimize(clock);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["torn"] = benchmark::Counter(static_cast<double>(torn),
+                                                benchmark::Counter::kDefaults);
+}
+BENCHMARK(BM_MediaClockRead)->Setup(StartWriter)->Teardown(StopWriter)
+        ->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+
+// the same read behind a mutex, as the clock was before
+static std::mutex sLockedMutex;
+static double sLockedDrift = BENCH_PTS_A;
+
+static void StartLockedWriter(const benchmark::State &) {
+    sStopWriter = false;
+    sWriter = std::thread([] {
+        int serial = 0;
+        while (!sStopWriter) {
+            double now = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            std::lock_guard<std::mutex> lock(sLockedMutex);
+            sLockedDrift = (serial++ % 2 ? BENCH_PTS_B : BENCH_PTS_A) - now;
+        }
+    });
+}
+
+static void BM_LockedClockRead(benchmark::State &state) {
+    for (auto _ : state) {
+        std::lock_guard<std::mutex> lock(sLockedMutex);
+        double now = std::chrono::duration<double>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        benchmark::DoNotOptimize(sLockedDrift + now);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockedClockRead)->Setup(StartLockedWriter)->Teardown(StopWriter)
+        ->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+
+// writes while readers poll, the seqlock makes every write two extra stores
+static void BM_MediaClockWrite(benchmark::State &state) {
+    MediaClock clock;
+    clock.SetPause(false);
+    std::atomic_bool stop {false};
+    std::thread reader([&] {
+        while (!stop) {
+            benchmark::DoNotOptimize(clock.GetClock());
+        }
+    });
+    double pts = 0;
+    for (auto _ : state) {
+        clock.SetClock(pts);
+        pts += 0.001;
+    }
+    stop = true;
+    reader.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MediaClockWrite)->UseRealTime();
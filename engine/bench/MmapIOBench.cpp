@@ -0,0 +1,169 @@
+/**
+ * Note: benchmarks of mmap io against read(2) of the file protocol
+ * Date: 2026/10/18
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "MmapIO.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavformat/avformat.h"
+#include "libavutil/mem.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define BENCH_FILE_SIZE (32 * 1024 * 1024)
+// what the demuxer asks for, the size of the AVIOContext buffer
+#define BENCH_READ_SIZE (32 * 1024)
+
+// written once, the page cache keeps it hot for every run
+static const std::string &BenchFile() {
+    static std::string path;
+    if (path.empty()) {
+        char name[] = "/tmp/mmap_bench_XXXXXX";
+        int fd = mkstemp(name);
+        std::vector<uint8_t> chunk(1024 * 1024);
+        for (size_t i = 0; i < chunk.size(); i++) {
+            chunk[i] = static_cast<uint8_t>(i % 251);
+        }
+        for (int i = 0; fd >= 0 && i < BENCH_FILE_SIZE / (int) chunk.size(); i++) {
+            if (write(fd, chunk.data(), chunk.size()) != (ssize_t) chunk.size()) {
+                break;
+            }
+        }
+        close(fd);
+        path = name;
+        atexit([] { unlink(path.c_str()); });
+    }
+    return path;
+}
+
+static int64_t PageFaults() {
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+// the file protocol: one read(2) per buffer refill
+struct FdSource {
+    int fd = -1;
+    int64_t reads = 0;
+    AVIOContext *ctx = nullptr;
+
+    explicit FdSource(const std::string &path) {
+        fd = open(path.c_str(), O_RDONLY);
+        auto *buffer = static_cast<uint8_t *>(av_malloc(BENCH_READ_SIZE));
+        ctx = avio_alloc_context(buffer, BENCH_READ_SIZE, 0, this, Read, nullptr, nullptr);
+    }
+
+    ~FdSource() {
+        av_freep(&ctx->buffer);
+        avio_context_free(&ctx);
+        close(fd);
+    }
+
+    static int Read(void *opaque, uint8_t *buf, int size) {
+        auto *src = static_cast<FdSource *>(opaque);
+        src->reads++;
+        ssize_t ret = read(src->fd, buf, size);
+        return ret > 0 ? static_cast<int>(ret) : AVERROR_EOF;
+    }
+};
+
+static int64_t ReadAll(AVIOContext *pb) {
+    std::vector<uint8_t> buf(BENCH_READ_SIZE);
+    int64_t total = 0;
+    int ret;
+    while ((ret = avio_read(pb, buf.data(), BENCH_READ_SIZE)) > 0) {
+        total += ret;
+    }
+    return total;
+}
+
+static void BM_ReadFileSyscall(benchmark::State &state) {
+    const std::string &path = BenchFile();
+    int64_t reads = 0;
+    int64_t faults = PageFaults();
+    for (auto _ : state) {
+        FdSource source(path);
+        benchmark::DoNotOptimize(ReadAll(source.ctx));
+        reads += source.reads;
+    }
+    faults = PageFaults() - faults;
+    state.SetBytesProcessed(state.iterations() * BENCH_FILE_SIZE);
+    state.counters["read_calls"] = benchmark::Counter(static_cast<double>(reads),
+                                                      benchmark::Counter::kAvgIterations);
+    state.counters["page_faults"] = benchmark::Counter(static_cast<double>(faults),
+                                                       benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ReadFileSyscall)->Unit(benchmark::kMillisecond);
+
+static void BM_ReadFileMmap(benchmark::State &state) {
+    const std::string &path = BenchFile();
+    int64_t faults = PageFaults();
+    for (auto _ : state) {
+        MmapIO io;
+        if (io.Open(path) < 0) {
+            state.SkipWithError("mmap failed");
+            break;
+        }
+        benchmark::DoNotOptimize(ReadAll(io.GetContext()));
+        io.Close();
+    }
+    faults = PageFaults() - faults;
+    state.SetBytesProcessed(state.iterations() * BENCH_FILE_SIZE);
+    state.counters["read_calls"] = 0;
+    state.counters["page_faults"] = benchmark::Counter(static_cast<double>(faults),
+                                                       benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ReadFileMmap)->Unit(benchmark::kMillisecond);
+
+// packets of a real file through either io, NEXT_BENCH_MEDIA names the file
+static void BM_DemuxFile(benchmark::State &state) {
+    const char *media = getenv("NEXT_BENCH_MEDIA");
+    if (!media) {
+        state.SkipWithError("NEXT_BENCH_MEDIA not set");
+        return;
+    }
+    bool mmap = state.range(0) != 0;
+    int64_t packets = 0;
+    AVPacket *pkt = av_packet_alloc();
+    for (auto _ : state) {
+        MmapIO io;
+        AVFormatContext *ctx = avformat_alloc_context();
+        if (mmap) {
+            if (io.Open(media) < 0) {
+                state.SkipWithError("mmap failed");
+                avformat_free_context(ctx);
+                break;
+            }
+            ctx->pb = io.GetContext();
+        }
+        if (avformat_open_input(&ctx, media, nullptr, nullptr) < 0) {
+            state.SkipWithError("open failed");
+            break;
+        }
+        while (av_read_frame(ctx, pkt) >= 0) {
+            packets++;
+            av_packet_unref(pkt);
+        }
+        avformat_close_input(&ctx);
+        io.Close();
+    }
+    av_packet_free(&pkt);
+    state.SetItemsProcessed(packets);
+}
+BENCHMARK(BM_DemuxFile)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,70 @@
+/**
+ * Note: benchmarks of the NAL unit converters
+ * Date: 2026/10/18
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+#include "NalUnitParser.h"
+#include "CommonUtil.h"
+
+extern "C" {
+#include "decode/common/nal_convert.h"
+}
+
+// length prefixed access unit of count slices of size bytes
+static std::vector<uint8_t> MakeAvccFrame(int count, int size) {
+    std::vector<uint8_t> frame;
+    for (int i = 0; i < count; i++) {
+        uint8_t len[4] = {(uint8_t) (size >> 24), (uint8_t) (size >> 16),
+                          (uint8_t) (size >> 8), (uint8_t) size};
+        frame.insert(frame.end(), len, len + 4);
+        frame.push_back(i == 0 ? 0x65 : 0x41);
+        frame.insert(frame.end(), size - 1, 0xAB);
+    }
+    return frame;
+}
+
+static void BM_AvccToAnnexB(benchmark::State &state) {
+    std::vector<uint8_t> source = MakeAvccFrame(8, static_cast<int>(state.range(0)) / 8);
+    std::vector<uint8_t> frame(source.size());
+    for (auto _ : state) {
+        memcpy(frame.data(), source.data(), source.size());
+        convert_avcc_to_annexb(frame.data(), frame.size());
+        benchmark::DoNotOptimize(frame.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+}
+BENCHMARK(BM_AvccToAnnexB)->Arg(16 << 10)->Arg(256 << 10);
+
+static void BM_H2645ToAnnexB(benchmark::State &state) {
+    std::vector<uint8_t> source = MakeAvccFrame(8, static_cast<int>(state.range(0)) / 8);
+    std::vector<uint8_t> frame(source.size());
+    for (auto _ : state) {
+        memcpy(frame.data(), source.data(), source.size());
+        H2645ConvertState convert = {0, 0};
+        convert_h2645_to_annexb(frame.data(), frame.size(), 4, &convert);
+        benchmark::DoNotOptimize(frame.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+}
+BENCHMARK(BM_H2645ToAnnexB)->Arg(16 << 10)->Arg(256 << 10);
+
+// what NextPacket does for every video packet to find key frames
+static void BM_ScanIdr(benchmark::State &state) {
+    std::vector<uint8_t> frame = MakeAvccFrame(8, static_cast<int>(state.range(0)) / 8);
+    for (auto _ : state) {
+        int idr = 0;
+        size_t offset = 0;
+        while (offset + 5 <= frame.size()) {
+            const uint8_t *nal = frame.data() + offset;
+            idr += NALUnitParser::is_h264_idr(NALUnitParser::get_h264_nal_unit_type(nal));
+            offset += ByteToInt(nal) + 4;
+        }
+        benchmark::DoNotOptimize(idr);
+    }
+}
+BENCHMARK(BM_ScanIdr)->Arg(16 << 10)->Arg(256 << 10);
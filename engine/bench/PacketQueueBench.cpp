@@ -0,0 +1,118 @@
+/**
+ * Note: benchmarks of NextPacketQueue, locked vs SPSC mode
+ * Date: 2026/10/18
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "NextErrorCode.h"
+#include "NextPacketPool.h"
+#include "NextPacketQueue.h"
+
+#define BENCH_QUEUE_SIZE 1024
+// demux of a high bitrate stream with many small audio/subtitle packets
+#define BENCH_PACED_RATE 1000000
+
+static int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// a producer thread putting shells of the pool, stamped with the put time
+class QueueProducer {
+public:
+    QueueProducer(PacketQueueMode mode, int64_t rate)
+            : mQueue(0, mode, BENCH_QUEUE_SIZE), mPool(BENCH_QUEUE_SIZE * 2), mRate(rate) {
+        PacketQueueWaterMark mark;
+        mark.high_packets = BENCH_QUEUE_SIZE;
+        mQueue.SetWaterMark(mark);
+        mPool.Reserve(BENCH_QUEUE_SIZE * 2);
+        mThread = std::thread(&QueueProducer::Run, this);
+    }
+
+    ~QueueProducer() {
+        bStop = true;
+        mQueue.Abort();
+        mThread.join();
+    }
+
+    NextPacketQueue &Queue() {
+        return mQueue;
+    }
+
+    NextPacketPool &Pool() {
+        return mPool;
+    }
+
+private:
+    void Run() {
+        int64_t interval = mRate > 0 ? 1000000000 / mRate : 0;
+        int64_t next = NowNs();
+        while (!bStop) {
+            if (interval > 0) {
+                // a sleep is far coarser than 1us, yield keeps one core usable
+                while (NowNs() < next && !bStop) {
+                    std::this_thread::yield();
+                }
+                next += interval;
+            }
+            std::unique_ptr<NextPacket> pkt = mPool.Obtain();
+            pkt->GetPacket()->pts = NowNs();
+            int ret;
+            while ((ret = mQueue.TryPutPacket(pkt)) == ERROR_PLAYER_TRY_AGAIN && !bStop) {
+                std::this_thread::yield();
+            }
+            if (ret != RESULT_OK) {
+                mPool.Recycle(pkt);
+            }
+        }
+    }
+
+private:
+    NextPacketQueue mQueue;
+    NextPacketPool mPool;
+    int64_t mRate = 0;
+    std::atomic_bool bStop {false};
+    std::thread mThread;
+};
+
+// as fast as the consumer takes them
+static void BM_PacketQueueTransfer(benchmark::State &state) {
+    QueueProducer producer(static_cast<PacketQueueMode>(state.range(0)), 0);
+    std::unique_ptr<NextPacket> pkt;
+    for (auto _ : state) {
+        if (producer.Queue().GetPacket(pkt, true) == RESULT_OK) {
+            producer.Pool().Recycle(pkt);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PacketQueueTransfer)->Arg(PKT_QUEUE_MODE_LOCKED)->Arg(PKT_QUEUE_MODE_SPSC)
+        ->UseRealTime();
+
+// put at 1M packets/s, the time from put to get
+static void BM_PacketQueuePaced(benchmark::State &state) {
+    QueueProducer producer(static_cast<PacketQueueMode>(state.range(0)), BENCH_PACED_RATE);
+    std::unique_ptr<NextPacket> pkt;
+    int64_t total = 0;
+    int64_t worst = 0;
+    for (auto _ : state) {
+        if (producer.Queue().GetPacket(pkt, true) == RESULT_OK) {
+            int64_t latency = NowNs() - pkt->GetPacket()->pts;
+            total += latency;
+            worst = std::max(worst, latency);
+            producer.Pool().Recycle(pkt);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["latency_ns"] = benchmark::Counter(
+            static_cast<double>(total), benchmark::Counter::kAvgIterations);
+    state.counters["max_latency_ns"] = static_cast<double>(worst);
+}
+BENCHMARK(BM_PacketQueuePaced)->Arg(PKT_QUEUE_MODE_LOCKED)->Arg(PKT_QUEUE_MODE_SPSC)
+        ->UseRealTime();
@@ -0,0 +1,178 @@
+/**
+ * Note: benchmarks of software video decode, the drain loop vs one frame per packet
+ * Date: 2026/10/18
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "decode/FFmpegVideoDecoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavformat/avformat.h"
+#ifdef __cplusplus
+}
+#endif
+
+enum BenchCorpus {
+    CORPUS_H264 = 0,
+    CORPUS_HEVC = 1
+};
+
+// 1080p files named by the environment, nothing to decode without them
+static const char *CorpusEnv(int corpus) {
+    return corpus == CORPUS_HEVC ? "NEXT_BENCH_HEVC" : "NEXT_BENCH_H264";
+}
+
+// the video packets of a file, demuxed once
+struct DemuxedStream {
+    MetaData meta;
+    std::vector<AVPacket *> packets;
+};
+
+static const DemuxedStream *LoadCorpus(int corpus) {
+    static std::map<int, DemuxedStream> sCache;
+    auto it = sCache.find(corpus);
+    if (it != sCache.end()) {
+        return &it->second;
+    }
+    const char *path = getenv(CorpusEnv(corpus));
+    AVFormatContext *ctx = nullptr;
+    if (!path || avformat_open_input(&ctx, path, nullptr, nullptr) < 0) {
+        return nullptr;
+    }
+    int index = -1;
+    if (avformat_find_stream_info(ctx, nullptr) < 0
+        || (index = av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0)) < 0) {
+        avformat_close_input(&ctx);
+        return nullptr;
+    }
+    DemuxedStream &stream = sCache[corpus];
+    AVStream *st = ctx->streams[index];
+    TrackInfo info;
+    info.codec_id     = st->codecpar->codec_id;
+    info.stream_type  = AVMEDIA_TYPE_VIDEO;
+    info.stream_index = 0;
+    info.width        = st->codecpar->width;
+    info.height       = st->codecpar->height;
+    info.fps_num      = st->avg_frame_rate.num;
+    info.fps_den      = st->avg_frame_rate.den;
+    info.extra_data   = MakeExtraData(st->codecpar->extradata, st->codecpar->extradata_size);
+    stream.meta.video_index = 0;
+    stream.meta.track_info.push_back(info);
+
+    AVPacket *pkt = av_packet_alloc();
+    while (av_read_frame(ctx, pkt) >= 0) {
+        if (pkt->stream_index == index) {
+            stream.packets.push_back(av_packet_clone(pkt));
+        }
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+    avformat_close_input(&ctx);
+    return &stream;
+}
+
+// counts the frames and hands them straight back to the pool
+class CountingCallback : public VideoDecodeCallback {
+public:
+    int OnDecodedFrame(std::unique_ptr<MixedBuffer> frame) override {
+        auto *context = reinterpret_cast<FFmpegBufferContext *>(
+                frame->GetVideoFrameMetadata()->buffer_context);
+        context->release_frame(context);
+        mFrames++;
+        return RESULT_OK;
+    }
+
+    void OnDecodeError(int error, int errorCode) override {}
+
+    int64_t mFrames = 0;
+};
+
+// FFmpegVideoDecoder, every ready frame is taken out after each packet
+static void BM_DecodeDrainLoop(benchmark::State &state) {
+    const DemuxedStream *stream = LoadCorpus(static_cast<int>(state.range(0)));
+    if (!stream) {
+        state.SkipWithError("corpus not set, see NEXT_BENCH_H264 / NEXT_BENCH_HEVC");
+        return;
+    }
+    CountingCallback callback;
+    for (auto _ : state) {
+        FFmpegVideoDecoder decoder(stream->meta.track_info[0].codec_id);
+        decoder.SetDecodeCallback(&callback);
+        if (decoder.Init(&stream->meta) != RESULT_OK
+            || decoder.SetVideoFormat(&stream->meta) != RESULT_OK) {
+            state.SkipWithError("decoder open failed");
+            break;
+        }
+        for (const AVPacket *pkt : stream->packets) {
+            // the codec was full, its frames are out now
+            while (decoder.Decode(pkt) == ERROR_PLAYER_TRY_AGAIN) {
+            }
+        }
+        // drain until eof
+        while (decoder.Decode(nullptr) == RESULT_OK) {
+        }
+        decoder.Release();
+    }
+    state.SetItemsProcessed(callback.mFrames);
+}
+BENCHMARK(BM_DecodeDrainLoop)->Arg(CORPUS_H264)->Arg(CORPUS_HEVC)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// the loop the decoder had before, one receive ahead of each send
+static void BM_DecodeOnePerPacket(benchmark::State &state) {
+    const DemuxedStream *stream = LoadCorpus(static_cast<int>(state.range(0)));
+    if (!stream) {
+        state.SkipWithError("corpus not set, see NEXT_BENCH_H264 / NEXT_BENCH_HEVC");
+        return;
+    }
+    const TrackInfo &info = stream->meta.track_info[0];
+    const AVCodec *codec = avcodec_find_decoder(static_cast<AVCodecID>(info.codec_id));
+    AVFrame *frame = av_frame_alloc();
+    int64_t frames = 0;
+    for (auto _ : state) {
+        AVCodecContext *ctx = avcodec_alloc_context3(codec);
+        ctx->thread_type = FF_THREAD_FRAME;
+        if (info.extra_data) {
+            auto size = static_cast<int>(info.extra_data->size());
+            ctx->extradata = reinterpret_cast<uint8_t *>(
+                    av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE));
+            ctx->extradata_size = size;
+            memcpy(ctx->extradata, info.extra_data->data(), size);
+        }
+        AVDictionary *opts = nullptr;
+        av_dict_set(&opts, "threads", "auto", 0);
+        int ret = avcodec_open2(ctx, codec, &opts);
+        av_dict_free(&opts);
+        if (ret < 0) {
+            avcodec_free_context(&ctx);
+            state.SkipWithError("decoder open failed");
+            break;
+        }
+        for (const AVPacket *pkt : stream->packets) {
+            if (avcodec_receive_frame(ctx, frame) >= 0) {
+                frames++;
+                av_frame_unref(frame);
+            }
+            avcodec_send_packet(ctx, pkt);
+        }
+        avcodec_send_packet(ctx, nullptr);
+        while (avcodec_receive_frame(ctx, frame) >= 0) {
+            frames++;
+            av_frame_unref(frame);
+        }
+        avcodec_free_context(&ctx);
+    }
+    av_frame_free(&frame);
+    state.SetItemsProcessed(frames);
+}
+BENCHMARK(BM_DecodeOnePerPacket)->Arg(CORPUS_H264)->Arg(CORPUS_HEVC)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -28,4 +28,15 @@ static inline int64_t CurrentTimeMs() {
             std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
+// 单调时钟，不受系统时间修改影响
+static inline int64_t SteadyTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline int64_t SteadyTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 #endif //COMMON_UTIL_H
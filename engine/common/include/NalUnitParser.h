@@ -69,7 +69,7 @@ public:
 
     // 获取hevc的编码层级nuh_layer_id
     static inline int get_hevc_nuh_layer_id(const uint8_t *data) {
-        return (data[4] & 0x1 << 5) + (data[5] >> 3) & 0x1F;
+        return ((data[4] & 0x1) << 5) | (data[5] >> 3);
     }
 
 };
@@ -27,7 +27,13 @@ enum VideoPixelFormat {
     PIXEL_FORMAT_RGB565       = 7,
     PIXEL_FORMAT_RGB888       = 8,
     PIXEL_FORMAT_RGBA8888     = 9,
-    PIXEL_FORMAT_HARMONY      = 10
+    PIXEL_FORMAT_HARMONY      = 10,
+    PIXEL_FORMAT_NV21         = 11, // YUV420SP is NV12
+    PIXEL_FORMAT_P010LE       = 12, // NV12 layout, 10 bits in the high bits of 16
+    PIXEL_FORMAT_YUV422P      = 13,
+    PIXEL_FORMAT_YUV444P      = 14,
+    PIXEL_FORMAT_YUV422P10LE  = 15,
+    PIXEL_FORMAT_YUV444P10LE  = 16
 };
 
 enum FrameQueueSize {
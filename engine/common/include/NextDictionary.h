@@ -2,6 +2,8 @@
 #ifndef NEXT_DICTIONARY_H
 #define NEXT_DICTIONARY_H
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 enum ValueType {
@@ -91,6 +91,7 @@
 #define ERROR_PLAYER_EOF          (-8004) // EOF结束
 #define ERROR_PLAYER_STATE        (-8005) // 播放状态不对
 #define ERROR_PLAYER_UNSUPPORTED  (-8006) // 不支持操作
+#define ERROR_PLAYER_ABORT        (-8007) // 已中止
 
 /**********************其他错误**********************/
 #define ERROR_OTHER_UNKNOWN       (-9999) // 未知错误
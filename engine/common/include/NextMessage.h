@@ -17,8 +17,8 @@ enum PlayerRequest {
 
 enum PlayerMsg {
     MSG_COMPONENT_OPEN     = 1000,
-    MSG_OPEN_INPUT         = 1001,
-    MSG_FIND_STREAM_INFO   = 1002,
+    MSG_OPEN_INPUT         = 1001, // arg1 = open cost in ms, arg2 = dns and connect part of it
+    MSG_FIND_STREAM_INFO   = 1002, // arg1 = probe cost in ms, arg2 = 1 if probe cache hit
     MSG_VIDEO_DECODER_OPEN = 1003,
     MSG_VIDEO_FIRST_PACKET = 1004,
     MSG_AUDIO_DECODE_START = 1005,
@@ -33,6 +33,8 @@ enum PlayerMsg {
     MSG_ON_ERROR           = 1014, //arg1 = error msg
     MSG_ON_COMPLETED       = 1015,
     MSG_MEDIA_INFO         = 1016,
+    MSG_OPEN_FIRST_PACKET  = 1017, // arg1 = open to first packet in ms, arg2 = 1 if probe cache hit
+    MSG_VARIANT_SWITCHED   = 1018, // arg1 = bitrate of the variant in kbps, arg2 = AdaptiveSwitchReason
 
     MSG_BUFFER_START       = 2000, // arg1: 1=seek 2=network 3=decode
     MSG_BUFFER_UPDATE      = 2001, // arg1 = progress percent
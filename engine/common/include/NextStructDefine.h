@@ -7,7 +7,9 @@
 #ifndef NEXT_STRUCT_DEFINE_H
 #define NEXT_STRUCT_DEFINE_H
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #define sp std::shared_ptr
@@ -16,6 +18,16 @@ using LogCallback    = std::function<void(int, const char*, const char*)>;
 using NotifyCallback = std::function<void(int, int, int, void*, int)>;
 using InjectCallback = std::function<int(void*, int, void*)>;
 
+// immutable, shared by every copy of a TrackInfo instead of copied
+using ExtraData = std::shared_ptr<const std::vector<uint8_t>>;
+
+inline ExtraData MakeExtraData(const uint8_t *data, int size) {
+    if (!data || size <= 0) {
+        return nullptr;
+    }
+    return std::make_shared<const std::vector<uint8_t>>(data, data + size);
+}
+
 struct TrackInfo {
     int codec_id      = 0;
     int stream_type   = -1;
@@ -45,20 +57,39 @@ struct TrackInfo {
     int sample_rate         = 0;
     int time_base_num       = 0;
     int time_base_den       = 1;
-    int extra_data_size     = 0;
-    uint8_t *extra_data     = nullptr;
+
+    ExtraData extra_data;
 };
 
-struct MetaData {
-    ~MetaData() {
-        for (auto & it : track_info) {
-            if (it.extra_data) {
-                delete[] it.extra_data;
-                it.extra_data = nullptr;
-            }
-        }
-    }
+// buffered data of the io layer below the demuxer
+struct IOCacheStatistic {
+    int64_t file_pos   = 0; // end offset of the buffered data
+    int64_t cache_size = 0; // bytes buffered ahead of the read position
+    int64_t file_size  = -1;
+};
+
+enum AdaptiveSwitchReason {
+    ADAPTIVE_SWITCH_NONE       = 0,
+    ADAPTIVE_SWITCH_UP         = 1, // throughput allows a higher bitrate
+    ADAPTIVE_SWITCH_DOWN       = 2, // throughput below the current bitrate
+    ADAPTIVE_SWITCH_LOW_BUFFER = 3, // little media downloaded ahead
+    ADAPTIVE_SWITCH_ERROR      = 4  // segment download failed
+};
 
+// variant selection of adaptive streaming
+struct AdaptiveStatistic {
+    int variant_index   = -1; // in bandwidth order
+    int variant_count   = 0;
+    int switch_count    = 0;
+    int switch_reason   = ADAPTIVE_SWITCH_NONE; // of the last switch
+    int64_t variant_bitrate = 0; // declared by the playlist, bps
+    int width  = 0; // declared by the playlist, 0 if unknown
+    int height = 0;
+    int64_t bandwidth   = 0; // estimated throughput, bps
+    int64_t buffer_us   = 0; // media downloaded ahead of the demuxer
+};
+
+struct MetaData {
     int64_t duration   = 0;
     int64_t bit_rate   = 0;
     int64_t start_time = 0;
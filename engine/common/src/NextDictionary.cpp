@@ -6,6 +6,7 @@
 
 #include "NextDictionary.h"
 
+#include <cstring>
 #include <string>
 
 NextDictionary::~NextDictionary() { Clear(); }
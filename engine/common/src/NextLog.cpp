@@ -106,6 +106,10 @@ int LogPrint(int level, const char *tag, const char *fmt, ...) {
         kLogContext.callback(kLogContext.userdata, level, output_buf);
         return 0;
     }
+#if defined(__LINUX_HOST__)
+    // host build has no platform logger
+    fprintf(stderr, "%s\n", output_buf);
+#endif
 
     return 0;
 }
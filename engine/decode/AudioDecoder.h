@@ -24,12 +24,16 @@ struct AudioCodecConfig {
     int channels       = 0;
     int sample_rate    = 0;
     int extradata_size = 0;
+    int thread_count   = 1; // 0: auto, few audio codecs are threaded
+    // > 0: coalesce smaller frames into chunks of this many ms, e.g. 20 for opus
+    int batch_ms       = 0;
     uint8_t *extradata = nullptr;
     char *codec_name   = nullptr;
 };
 
 class AudioDecodeCallback {
 public:
+    // the callee owns frame
     virtual int OnDecodedFrame(AVFrame *frame) = 0;
 
     virtual void OnDecodeError(int error) = 0;
@@ -44,6 +48,7 @@ public:
 
     virtual int Init(AudioCodecConfig &config) = 0;
 
+    // every frame the packet produces is output, a null or empty packet drains
     virtual int Decode(const AVPacket *pkt) = 0;
 
     virtual int Flush() = 0;
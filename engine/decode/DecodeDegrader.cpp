@@ -0,0 +1,60 @@
+/**
+ * Note: skip level of the software decoder from its decode rate
+ * Date: 2026/10/18
+ */
+
+#include "decode/DecodeDegrader.h"
+
+void DecodeDegrader::SetFrameRate(double fps) {
+    mFrameRate = fps;
+}
+
+void DecodeDegrader::Reset() {
+    mWindowStart = -1;
+    mBusyUs  = 0;
+    mPackets = 0;
+}
+
+bool DecodeDegrader::AddSample(int64_t nowUs, int64_t busyUs) {
+    if (mFrameRate <= 0) {
+        return false;
+    }
+    if (mWindowStart < 0) {
+        mWindowStart = nowUs;
+    }
+    mBusyUs += busyUs;
+    mPackets++;
+    if (nowUs - mWindowStart < DEGRADE_WINDOW_US || mBusyUs <= 0) {
+        return false;
+    }
+
+    mDecodeRate = static_cast<double>(mPackets) * 1000000 / mBusyUs;
+    Reset();
+
+    int level = mLevel;
+    if (mDecodeRate < mFrameRate * DEGRADE_SLOW_RATIO) {
+        mFastWindows = 0;
+        if (++mSlowWindows >= DEGRADE_RAISE_WINDOWS && mLevel < DEGRADE_MAX_LEVEL) {
+            mLevel++;
+            mSlowWindows = 0;
+        }
+    } else if (mDecodeRate > mFrameRate * DEGRADE_FAST_RATIO) {
+        mSlowWindows = 0;
+        if (++mFastWindows >= DEGRADE_LOWER_WINDOWS && mLevel > 0) {
+            mLevel--;
+            mFastWindows = 0;
+        }
+    } else {
+        mSlowWindows = 0;
+        mFastWindows = 0;
+    }
+    return level != mLevel;
+}
+
+int DecodeDegrader::GetLevel() const {
+    return mLevel;
+}
+
+double DecodeDegrader::GetDecodeRate() const {
+    return mDecodeRate;
+}
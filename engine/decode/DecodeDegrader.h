@@ -0,0 +1,48 @@
+#ifndef DECODE_DEGRADER_H
+#define DECODE_DEGRADER_H
+
+#include <cstdint>
+
+#define DEGRADE_MAX_LEVEL 3
+#define DEGRADE_WINDOW_US (1000 * 1000)
+// consecutive windows before the level moves, restoring is slower
+#define DEGRADE_RAISE_WINDOWS 2
+#define DEGRADE_LOWER_WINDOWS 5
+// decode rate relative to the frame rate
+#define DEGRADE_SLOW_RATIO 0.95
+#define DEGRADE_FAST_RATIO 1.5
+
+/**
+ * Picks the skip level of a software decoder from its decode rate: frames
+ * per second of time spent decoding, which is what it could sustain if
+ * never waiting for packets or the renderer. The level goes up while that
+ * is below the frame rate and back down once there is a clear margin.
+ */
+class DecodeDegrader {
+public:
+    // content frame rate, <= 0 disables the degrader
+    void SetFrameRate(double fps);
+
+    // drop the current window, e.g. after a flush, the level is kept
+    void Reset();
+
+    // one packet went through the decoder in busyUs, true if the level changed
+    bool AddSample(int64_t nowUs, int64_t busyUs);
+
+    int GetLevel() const;
+
+    double GetDecodeRate() const;
+
+private:
+    double mFrameRate = 0;
+    double mDecodeRate = 0;
+    int mLevel = 0;
+
+    int64_t mWindowStart = -1;
+    int64_t mBusyUs  = 0;
+    int mPackets     = 0;
+    int mSlowWindows = 0;
+    int mFastWindows = 0;
+};
+
+#endif //DECODE_DEGRADER_H
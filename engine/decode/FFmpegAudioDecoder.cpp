@@ -5,6 +5,9 @@
  */
 
 #include "FFmpegAudioDecoder.h"
+
+#include <algorithm>
+
 #include "NextErrorCode.h"
 #include "NextLog.h"
 
@@ -28,7 +31,8 @@ int FFmpegAudioDecoder::Init(AudioCodecConfig &config) {
     mCodecContext->time_base    = {1, 1000}; // TODO: timebase
     mCodecContext->codec_type   = AVMEDIA_TYPE_AUDIO;
     mCodecContext->sample_rate  = config.sample_rate;
-    mCodecContext->thread_count = 1;
+    mCodecContext->thread_count = config.thread_count;
+    mBatchMs = std::max(config.batch_ms, 0);
     mCodecContext->ch_layout.nb_channels = config.channels;
 
     if (config.extradata_size > 0) {
@@ -49,7 +53,9 @@ int FFmpegAudioDecoder::Init(AudioCodecConfig &config) {
     AVDictionary *opts = nullptr;
     av_dict_set(&opts, "refcounted_frames", "1", 0);
     if ((ret = avcodec_open2(mCodecContext, codec, nullptr)) < 0) {
-        NEXT_LOGE(FFMPEG_AUDIO_TAG, "avcodec_open2 fail, msg=%s", av_err2str(ret));
+        char errBuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        NEXT_LOGE(FFMPEG_AUDIO_TAG, "avcodec_open2 fail, msg=%s", errBuf);
         av_dict_free(&opts);
         Release();
         return ERROR_DECODE_AUDIO_OPEN;
@@ -60,36 +66,137 @@ int FFmpegAudioDecoder::Init(AudioCodecConfig &config) {
 }
 
 int FFmpegAudioDecoder::Decode(const AVPacket *pkt) {
-    if (!pkt || !mCodecContext || !mAudioDecodedCallback) {
+    if (!mCodecContext || !mAudioDecodedCallback) {
         return ERROR_DECODE_NOT_INIT;
     }
 
-    int ret = avcodec_send_packet(mCodecContext, pkt);
-    if (ret < 0) {
-        return ret;
+    if (!bFlushState) {
+        bool drain = !pkt || pkt->size == 0;
+        int ret = avcodec_send_packet(mCodecContext, drain ? nullptr : pkt);
+        if (ret == AVERROR(EAGAIN)) {
+            // the codec is full, take its frames out and try once more
+            ret = ReceiveFrames();
+            if (ret < 0) {
+                return ret;
+            }
+            ret = avcodec_send_packet(mCodecContext, drain ? nullptr : pkt);
+            if (ret == AVERROR(EAGAIN)) {
+                return ERROR_PLAYER_TRY_AGAIN;
+            }
+        }
+        if (ret < 0 && ret != AVERROR_EOF) {
+            return ret;
+        }
+        bFlushState = drain;
     }
 
-    AVFrame *frame = av_frame_alloc();
-    ret = avcodec_receive_frame(mCodecContext, frame);
-    if (ret < 0) {
-        av_frame_free(&frame);
-        switch (ret) {
-            case AVERROR(EAGAIN):
-                return ERROR_PLAYER_TRY_AGAIN;
-            case AVERROR_EOF:
-                NEXT_LOGI(FFMPEG_AUDIO_TAG, "avcodec_receive_frame EOF...");
-                return ERROR_PLAYER_EOF;
-            default:
-                return ret;
+    return ReceiveFrames();
+}
+
+int FFmpegAudioDecoder::ReceiveFrames() {
+    int ret = 0;
+    AVFrame *frame = nullptr;
+    // a packet may hold several frames, or none yet
+    for (;;) {
+        if (!frame && !(frame = av_frame_alloc())) {
+            return ERROR_DECODE_AUDIO_DEC;
         }
+        ret = avcodec_receive_frame(mCodecContext, frame);
+        if (ret < 0) {
+            break;
+        }
+        OutputFrame(frame);
+        frame = nullptr;
     }
+    av_frame_free(&frame);
 
-    mAudioDecodedCallback->OnDecodedFrame(frame);
+    if (ret == AVERROR(EAGAIN)) {
+        return RESULT_OK;
+    }
+    // the tail of the stream doesn't wait for a full batch
+    EmitBatch();
+    if (ret == AVERROR_EOF) {
+        NEXT_LOGI(FFMPEG_AUDIO_TAG, "avcodec_receive_frame EOF...");
+        return ERROR_PLAYER_EOF;
+    }
+    return ret;
+}
 
-    return RESULT_OK;
+void FFmpegAudioDecoder::OutputFrame(AVFrame *frame) {
+    if (mBatchMs <= 0) {
+        mAudioDecodedCallback->OnDecodedFrame(frame);
+        return;
+    }
+
+    if (mBatchFrame && !CanAppend(frame)) {
+        EmitBatch();
+    }
+    int batchSize = static_cast<int>(
+            av_rescale(frame->sample_rate, mBatchMs, 1000));
+    // big enough on its own, skip the copy
+    if (!mBatchFrame && frame->nb_samples >= batchSize) {
+        mAudioDecodedCallback->OnDecodedFrame(frame);
+        return;
+    }
+
+    if (!mBatchFrame) {
+        mBatchFrame = av_frame_alloc();
+        if (!mBatchFrame) {
+            mAudioDecodedCallback->OnDecodedFrame(frame);
+            return;
+        }
+        mBatchFrame->format      = frame->format;
+        mBatchFrame->sample_rate = frame->sample_rate;
+        mBatchFrame->nb_samples  = batchSize;
+        if (av_channel_layout_copy(&mBatchFrame->ch_layout, &frame->ch_layout) < 0 ||
+            av_frame_get_buffer(mBatchFrame, 0) < 0) {
+            av_frame_free(&mBatchFrame);
+            mAudioDecodedCallback->OnDecodedFrame(frame);
+            return;
+        }
+        // timestamps of the batch are the first frame's
+        av_frame_copy_props(mBatchFrame, frame);
+        mBatchFrame->duration   = 0;
+        mBatchFrame->nb_samples = 0;
+        mBatchSize = batchSize;
+    }
+
+    av_samples_copy(mBatchFrame->extended_data, frame->extended_data,
+                    mBatchFrame->nb_samples, 0, frame->nb_samples,
+                    frame->ch_layout.nb_channels, static_cast<AVSampleFormat>(frame->format));
+    mBatchFrame->nb_samples += frame->nb_samples;
+    mBatchFrame->duration   += frame->duration;
+    av_frame_free(&frame);
+
+    if (mBatchFrame->nb_samples >= mBatchSize) {
+        EmitBatch();
+    }
+}
+
+bool FFmpegAudioDecoder::CanAppend(const AVFrame *frame) const {
+    return frame->format == mBatchFrame->format &&
+           frame->sample_rate == mBatchFrame->sample_rate &&
+           av_channel_layout_compare(&frame->ch_layout, &mBatchFrame->ch_layout) == 0 &&
+           mBatchFrame->nb_samples + frame->nb_samples <= mBatchSize;
+}
+
+void FFmpegAudioDecoder::EmitBatch() {
+    if (!mBatchFrame) {
+        return;
+    }
+    AVFrame *frame = mBatchFrame;
+    mBatchFrame = nullptr;
+    if (frame->nb_samples > 0) {
+        mAudioDecodedCallback->OnDecodedFrame(frame);
+    } else {
+        av_frame_free(&frame);
+    }
 }
 
 int FFmpegAudioDecoder::Flush() {
+    bFlushState = false;
+    // samples from before a seek must not reach the renderer
+    av_frame_free(&mBatchFrame);
     if (mCodecContext) {
         avcodec_flush_buffers(mCodecContext);
     }
@@ -98,6 +205,7 @@ int FFmpegAudioDecoder::Flush() {
 
 int FFmpegAudioDecoder::Release() {
     NEXT_LOGI(FFMPEG_AUDIO_TAG, "Release...");
+    av_frame_free(&mBatchFrame);
     if (mCodecContext) {
         avcodec_free_context(&mCodecContext);
         mCodecContext = nullptr;
@@ -24,7 +24,25 @@ public:
     void SetDecodeCallback(AudioDecodeCallback *callback) override;
 
 private:
-    AVCodecContext *mCodecContext;
+    // drain the frames the codec has ready
+    int ReceiveFrames();
+
+    // to the callback directly or through the batch
+    void OutputFrame(AVFrame *frame);
+
+    // hand the pending batch to the callback
+    void EmitBatch();
+
+    bool CanAppend(const AVFrame *frame) const;
+
+private:
+    bool bFlushState = false;
+    AVCodecContext *mCodecContext = nullptr;
+
+    // frame being filled in batching mode, capacity of mBatchSize samples
+    AVFrame *mBatchFrame = nullptr;
+    int mBatchMs   = 0;
+    int mBatchSize = 0;
 
 };
 
@@ -6,17 +6,20 @@
 
 #include "decode/FFmpegVideoDecoder.h"
 
-#include "NextLog.h"
+#include <algorithm>
 
-#define FFMPEG_VIDEO_TAG "FFmpegVideoDec"
+#include "NextLog.h"
 
-static void ReleaseFrame(FFmpegBufferContext *context) {
-    if (context && context->av_frame) {
-        auto *frame = reinterpret_cast<AVFrame *>(context->av_frame);
-        av_frame_unref(frame);
-        av_frame_free(&frame);
-    }
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+#ifdef __cplusplus
 }
+#endif
+
+#define FFMPEG_VIDEO_TAG "FFmpegVideoDec"
 
 FFmpegVideoDecoder::FFmpegVideoDecoder(int codecId)
         : VideoDecoder(codecId) {}
@@ -29,11 +32,17 @@ int FFmpegVideoDecoder::Init(const MetaData *metadata) {
     mCodecContext = avcodec_alloc_context3(nullptr);
 
     mCodecContext->codec_type   = AVMEDIA_TYPE_VIDEO;
-    mCodecContext->thread_count = 0; // auto
-    mCodecContext->thread_type  = FF_THREAD_FRAME;
+    mCodecContext->thread_count = mOption.thread_count; // 0: auto
+    mCodecContext->thread_type  = mOption.thread_type;
     mCodecContext->time_base    = {1, 1000};
 
     mCodecContext->codec_id = (AVCodecID) mCodecId;
+    ApplySkip(0);
+    UpdateFrameRate(metadata);
+
+    // frames and planes come from the pool instead of the heap
+    mFramePool = VideoFramePool::Create();
+    mFramePool->Attach(mCodecContext);
 
     auto *codec = const_cast<AVCodec *>(avcodec_find_decoder(mCodecContext->codec_id));
     if (!codec) {
@@ -62,77 +71,143 @@ int FFmpegVideoDecoder::Decode(const AVPacket *pkt) {
         return ERROR_DECODE_NOT_INIT;
     }
 
-    AVFrame *frame = av_frame_alloc();
-    int ret = avcodec_receive_frame(mCodecContext, frame);
-
-    if (ret >= 0) {
-        size_t bufferSize = 1;
-        std::unique_ptr<MixedBuffer> output_buffer =
-                std::make_unique<MixedBuffer>(BufferType::BUFFER_VIDEO_FRAME, bufferSize);
-
-        VideoFrameMetadata *meta = output_buffer->GetVideoFrameMetadata();
-        meta->width    = frame->width;
-        meta->height   = frame->height;
-        meta->stride_y = frame->linesize[0];
-        meta->stride_u = frame->linesize[1];
-        meta->stride_v = frame->linesize[2];
-
-        meta->buffer_y = frame->data[0];
-        meta->buffer_u = frame->data[1];
-        meta->buffer_v = frame->data[2];
-
-        meta->buffer_context = reinterpret_cast<void *>(new FFmpegBufferContext{
-                .av_frame = frame,
-                .release_frame = ReleaseFrame,
-        });
-
-        switch (frame->format) {
-            case AV_PIX_FMT_YUVJ420P:
-                meta->pixel_format = VideoPixelFormat::PIXEL_FORMAT_YUVJ420P;
-                break;
-            case AV_PIX_FMT_YUV420P10LE:
-                meta->pixel_format = VideoPixelFormat::PIXEL_FORMAT_YUV420P10LE;
-                break;
-            case AV_PIX_FMT_YUV420P:
-                meta->pixel_format = VideoPixelFormat::PIXEL_FORMAT_YUV420P;
-                break;
-            default:
-                meta->pixel_format = VideoPixelFormat::PIXEL_FORMAT_YUV420P;
-                NEXT_LOGW(FFMPEG_VIDEO_TAG, "unsupported pixel format %d", frame->format);
-                break;
+    // draining says nothing about the decode rate
+    bool measure = mOption.auto_degrade && pkt && pkt->size > 0;
+    int64_t begin = measure ? av_gettime_relative() : 0;
+    int ret = DecodePacket(pkt);
+    if (measure) {
+        int64_t now = av_gettime_relative();
+        if (mDegrader.AddSample(now, now - begin)) {
+            NEXT_LOGI(FFMPEG_VIDEO_TAG, "degrade level=%d, decode_rate=%.1f",
+                      mDegrader.GetLevel(), mDegrader.GetDecodeRate());
+            ApplySkip(mDegrader.GetLevel());
+        }
+    }
+    return ret;
+}
+
+int FFmpegVideoDecoder::DecodePacket(const AVPacket *pkt) {
+    if (!bFlushState) {
+        // an empty packet starts draining the delayed frames
+        bool drain = !pkt || pkt->size == 0;
+        // the packet goes in whole, flags and side data included
+        int ret = avcodec_send_packet(mCodecContext, drain ? nullptr : pkt);
+        if (ret == AVERROR(EAGAIN)) {
+            // the codec is full, take its frames out and try once more
+            ret = ReceiveFrames();
+            if (ret < 0) {
+                return ret;
+            }
+            ret = avcodec_send_packet(mCodecContext, drain ? nullptr : pkt);
+            if (ret == AVERROR(EAGAIN)) {
+                return ERROR_PLAYER_TRY_AGAIN;
+            }
         }
+        if (ret < 0 && ret != AVERROR_EOF) {
+            NEXT_LOGW(FFMPEG_VIDEO_TAG, "avcodec_send_packet error, ret=%d", ret);
+        }
+        bFlushState = drain;
+    }
 
-        meta->pts = frame->best_effort_timestamp;
-        meta->dts = frame->pkt_dts;
+    return ReceiveFrames();
+}
 
-        mVideoDecodeCallback->OnDecodedFrame(std::move(output_buffer));
-    } else if (ret == AVERROR_EOF) {
-        av_frame_unref(frame);
-        av_frame_free(&frame);
+int FFmpegVideoDecoder::ReceiveFrames() {
+    int ret = 0;
+    FFmpegBufferContext *context = nullptr;
+    // every frame that is ready, frame threading may hold several
+    for (;;) {
+        if (!context && !(context = mFramePool->Obtain())) {
+            return ERROR_DECODE_VIDEO_DEC;
+        }
+        ret = avcodec_receive_frame(mCodecContext,
+                                    reinterpret_cast<AVFrame *>(context->av_frame));
+        if (ret < 0) {
+            break;
+        }
+        OutputFrame(context);
+        context = nullptr;
+    }
+    context->release_frame(context);
+
+    if (ret == AVERROR(EAGAIN)) {
+        return RESULT_OK;
+    }
+    if (ret == AVERROR_EOF) {
         return ERROR_PLAYER_EOF;
-    } else {
-        av_frame_unref(frame);
-        av_frame_free(&frame);
     }
+    NEXT_LOGE(FFMPEG_VIDEO_TAG, "avcodec_receive_frame error, ret=%d", ret);
+    return ERROR_DECODE_VIDEO_DEC;
+}
 
-    AVPacket packet;
-    av_init_packet(&packet);
-    packet.data = pkt->data;
-    packet.size = pkt->size;
-    packet.pts  = pkt->pts;
-    packet.dts  = pkt->dts;
+static VideoPixelFormat ToPixelFormat(int format) {
+    switch (format) {
+        case AV_PIX_FMT_YUV420P:
+            return PIXEL_FORMAT_YUV420P;
+        case AV_PIX_FMT_YUVJ420P:
+            return PIXEL_FORMAT_YUVJ420P;
+        case AV_PIX_FMT_YUV420P10LE:
+            return PIXEL_FORMAT_YUV420P10LE;
+        case AV_PIX_FMT_NV12:
+            return PIXEL_FORMAT_YUV420SP;
+        case AV_PIX_FMT_NV21:
+            return PIXEL_FORMAT_NV21;
+        case AV_PIX_FMT_P010LE:
+            return PIXEL_FORMAT_P010LE;
+        // full range of the J formats is carried by the color range
+        case AV_PIX_FMT_YUV422P:
+        case AV_PIX_FMT_YUVJ422P:
+            return PIXEL_FORMAT_YUV422P;
+        case AV_PIX_FMT_YUV444P:
+        case AV_PIX_FMT_YUVJ444P:
+            return PIXEL_FORMAT_YUV444P;
+        case AV_PIX_FMT_YUV422P10LE:
+            return PIXEL_FORMAT_YUV422P10LE;
+        case AV_PIX_FMT_YUV444P10LE:
+            return PIXEL_FORMAT_YUV444P10LE;
+        default:
+            return PIXEL_FORMAT_UNKNOWN;
+    }
+}
 
-    if (!bFlushState) {
-        if (packet.size == 0) {
-            bFlushState = true;
-        }
-        ret = avcodec_send_packet(mCodecContext, bFlushState ? nullptr : &packet);
-        if (ret == AVERROR(EAGAIN)) {
-            return ERROR_PLAYER_TRY_AGAIN;
+void FFmpegVideoDecoder::OutputFrame(FFmpegBufferContext *context) {
+    auto *frame = reinterpret_cast<AVFrame *>(context->av_frame);
+    VideoPixelFormat pixelFormat = ToPixelFormat(frame->format);
+    if (pixelFormat == PIXEL_FORMAT_UNKNOWN) {
+        // the renderer has no shader for it, drop instead of showing garbage
+        if (frame->format != mUnsupportedFormat) {
+            mUnsupportedFormat = frame->format;
+            NEXT_LOGE(FFMPEG_VIDEO_TAG, "unsupported pixel format %s",
+                      av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format)));
+            mVideoDecodeCallback->OnDecodeError(ERROR_DECODER_UNSUPPORTED, frame->format);
         }
+        context->release_frame(context);
+        return;
     }
 
-    return RESULT_OK;
+    // the planes are owned by the frame, no payload of its own
+    std::unique_ptr<MixedBuffer> output_buffer =
+            std::make_unique<MixedBuffer>(BufferType::BUFFER_VIDEO_FRAME, nullptr, 0, false);
+
+    VideoFrameMetadata *meta = output_buffer->GetVideoFrameMetadata();
+    meta->width    = frame->width;
+    meta->height   = frame->height;
+    meta->stride_y = frame->linesize[0];
+    meta->stride_u = frame->linesize[1];
+    meta->stride_v = frame->linesize[2];
+
+    // semi-planar formats leave buffer_v null, uv are interleaved in buffer_u
+    meta->buffer_y = frame->data[0];
+    meta->buffer_u = frame->data[1];
+    meta->buffer_v = frame->data[2];
+
+    meta->buffer_context = reinterpret_cast<void *>(context);
+    meta->pixel_format   = pixelFormat;
+
+    meta->pts = frame->best_effort_timestamp;
+    meta->dts = frame->pkt_dts;
+
+    mVideoDecodeCallback->OnDecodedFrame(std::move(output_buffer));
 }
 
 int FFmpegVideoDecoder::SetVideoFormat(const MetaData *metadata) {
@@ -146,13 +221,21 @@ int FFmpegVideoDecoder::SetVideoFormat(const MetaData *metadata) {
         return ERROR_DECODE_NOT_INIT;
     }
 
-    auto trackInfo = metadata->track_info[metadata->video_index];
+    const TrackInfo &trackInfo = metadata->track_info[metadata->video_index];
+    UpdateFrameRate(metadata);
 
-    if (trackInfo.extra_data && trackInfo.extra_data_size > 0) {
+    // the codec context owns a padded copy, avcodec frees it
+    if (trackInfo.extra_data && !trackInfo.extra_data->empty()) {
+        auto size = static_cast<int>(trackInfo.extra_data->size());
+        av_freep(&mCodecContext->extradata);
         mCodecContext->extradata = reinterpret_cast<uint8_t *>(
-                av_malloc(trackInfo.extra_data_size + AV_INPUT_BUFFER_PADDING_SIZE));
-        mCodecContext->extradata_size = trackInfo.extra_data_size;
-        memcpy(mCodecContext->extradata, trackInfo.extra_data, trackInfo.extra_data_size);
+                av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!mCodecContext->extradata) {
+            mCodecContext->extradata_size = 0;
+            return ERROR_DECODE_VIDEO_OPEN;
+        }
+        mCodecContext->extradata_size = size;
+        memcpy(mCodecContext->extradata, trackInfo.extra_data->data(), size);
     }
 
     auto *codec = const_cast<AVCodec *>(avcodec_find_decoder(mCodecContext->codec_id));
@@ -168,7 +251,11 @@ int FFmpegVideoDecoder::SetVideoFormat(const MetaData *metadata) {
     }
 
     AVDictionary *opts = nullptr;
-    av_dict_set(&opts, "threads", "auto", 0);
+    if (mOption.thread_count > 0) {
+        av_dict_set_int(&opts, "threads", mOption.thread_count, 0);
+    } else {
+        av_dict_set(&opts, "threads", "auto", 0);
+    }
     av_dict_set(&opts, "refcounted_frames", "1", 0);
 
     if ((ret = avcodec_open2(mCodecContext, codec, &opts)) < 0) {
@@ -183,17 +270,58 @@ int FFmpegVideoDecoder::SetVideoFormat(const MetaData *metadata) {
 
 int FFmpegVideoDecoder::Flush() {
     bFlushState = false;
+    mDegrader.Reset();
     if (mCodecContext) {
         avcodec_flush_buffers(mCodecContext);
     }
     return RESULT_OK;
 }
 
+int FFmpegVideoDecoder::GetDegradeLevel() {
+    return mDegrader.GetLevel();
+}
+
+void FFmpegVideoDecoder::UpdateFrameRate(const MetaData *metadata) {
+    if (!metadata || metadata->video_index < 0) {
+        return;
+    }
+    const TrackInfo &trackInfo = metadata->track_info[metadata->video_index];
+    if (trackInfo.fps_num > 0 && trackInfo.fps_den > 0) {
+        mDegrader.SetFrameRate(static_cast<double>(trackInfo.fps_num) / trackInfo.fps_den);
+    }
+}
+
+void FFmpegVideoDecoder::ApplySkip(int level) {
+    // the configured values are the floor, each level adds to them
+    int loopFilter = mOption.skip_loop_filter;
+    int idct       = mOption.skip_idct;
+    int frame      = mOption.skip_frame;
+    if (level >= 1) {
+        loopFilter = std::max(loopFilter, static_cast<int>(AVDISCARD_NONREF));
+    }
+    if (level >= 2) {
+        loopFilter = std::max(loopFilter, static_cast<int>(AVDISCARD_ALL));
+        idct       = std::max(idct, static_cast<int>(AVDISCARD_NONREF));
+    }
+    if (level >= 3) {
+        frame = std::max(frame, static_cast<int>(AVDISCARD_NONREF));
+    }
+    // read by the codec for every packet, frame threads pick them up on submit
+    mCodecContext->skip_loop_filter = static_cast<AVDiscard>(loopFilter);
+    mCodecContext->skip_idct        = static_cast<AVDiscard>(idct);
+    mCodecContext->skip_frame       = static_cast<AVDiscard>(frame);
+}
+
 int FFmpegVideoDecoder::Release() {
     NEXT_LOGD(FFMPEG_VIDEO_TAG, "Release...");
     if (mCodecContext) {
         avcodec_free_context(&mCodecContext);
         mCodecContext = nullptr;
     }
+    // frames still on screen keep the pool until they are released
+    if (mFramePool) {
+        mFramePool->Release();
+        mFramePool = nullptr;
+    }
     return RESULT_OK;
 }
@@ -2,7 +2,9 @@
 #define FFMPEG_VIDEO_DECODER_H
 
 #include "decode/common/VideoCodecInfo.h"
+#include "decode/DecodeDegrader.h"
 #include "decode/VideoDecoder.h"
+#include "decode/VideoFramePool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,11 +28,31 @@ public:
 
     int SetVideoFormat(const MetaData *metadata) override;
 
+    int GetDegradeLevel() override;
+
     int Release() override;
 
+private:
+    // send pkt, an empty one drains, and output what is ready
+    int DecodePacket(const AVPacket *pkt);
+
+    // drain the frames the codec has ready
+    int ReceiveFrames();
+
+    // hand the frame to the callback, which owns it from then on
+    void OutputFrame(FFmpegBufferContext *context);
+
+    void UpdateFrameRate(const MetaData *metadata);
+
+    // skip settings of the option raised to the degrade level
+    void ApplySkip(int level);
+
 private:
     bool bFlushState = false;
+    int mUnsupportedFormat = AV_PIX_FMT_NONE; // reported once
     AVCodecContext *mCodecContext = nullptr;
+    VideoFramePool *mFramePool = nullptr;
+    DecodeDegrader mDegrader;
 
 };
 
@@ -14,3 +14,7 @@ VideoDecoder::~VideoDecoder() = default;
 void VideoDecoder::SetDecodeCallback(VideoDecodeCallback *callback) {
     mVideoDecodeCallback = callback;
 }
+
+void VideoDecoder::SetDecoderOption(const VideoDecoderOption &option) {
+    mOption = option;
+}
@@ -13,6 +13,7 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#include "libavcodec/defs.h"
 #include "libavcodec/packet.h"
 #ifdef __cplusplus
 }
@@ -30,6 +31,23 @@ struct CodecContext {
     AVColorRange color_range = AVCOL_RANGE_MPEG;
 };
 
+enum DecodeThreadType {
+    DECODE_THREAD_FRAME = 1, // FF_THREAD_FRAME, more latency, scales with any stream
+    DECODE_THREAD_SLICE = 2, // FF_THREAD_SLICE, needs streams encoded with slices
+    DECODE_THREAD_ANY   = 3  // let the codec choose
+};
+
+// per-session settings of the software decoder, skip_* take AVDiscard values
+struct VideoDecoderOption {
+    int thread_type      = DECODE_THREAD_FRAME;
+    int thread_count     = 0; // 0: auto
+    int skip_loop_filter = AVDISCARD_DEFAULT;
+    int skip_frame       = AVDISCARD_DEFAULT;
+    int skip_idct        = AVDISCARD_DEFAULT;
+    // raise the skip levels while decoding is slower than the frame rate
+    bool auto_degrade    = false;
+};
+
 class VideoDecodeCallback {
 public:
     virtual int OnDecodedFrame(std::unique_ptr<MixedBuffer> frame) = 0;
@@ -49,7 +67,15 @@ public:
 
     virtual int Decode(const AVPacket *pkt) = 0;
 
-    virtual void SetDecodeCallback(VideoDecodeCallback *callback) = 0;
+    virtual void SetDecodeCallback(VideoDecodeCallback *callback);
+
+    // before Init
+    virtual void SetDecoderOption(const VideoDecoderOption &option);
+
+    // skip level of the degrade mode, 0: as configured
+    virtual int GetDegradeLevel() {
+        return 0;
+    }
 
     virtual int SetVideoFormat(const MetaData *metadata) = 0;
 
@@ -68,6 +94,7 @@ public:
 protected:
     int mCodecId = -1;
     VideoDecodeCallback *mVideoDecodeCallback = nullptr;
+    VideoDecoderOption mOption;
 };
 
 #endif
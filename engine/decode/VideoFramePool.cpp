@@ -0,0 +1,255 @@
+/**
+ * Note: recycle pool of decoded video frames and their planes
+ * Date: 2026/10/18
+ */
+
+#include "decode/VideoFramePool.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "NextLog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define TAG "VideoFramePool"
+
+#define LOCK_GUARD std::lock_guard<std::mutex>
+
+// SIMD of the decoders may read past the plane, as in avcodec_default_get_buffer2
+#define PLANE_PADDING (16 + 64 - 1)
+
+VideoFramePool *VideoFramePool::Create(int maxSize) {
+    return new VideoFramePool(maxSize);
+}
+
+VideoFramePool::VideoFramePool(int maxSize)
+        : mMaxSize(maxSize > 0 ? maxSize : DEFAULT_FRAME_POOL_SIZE) {
+    mFreeFrames.reserve(mMaxSize);
+}
+
+VideoFramePool::~VideoFramePool() {
+    for (auto *context : mFreeFrames) {
+        auto *frame = reinterpret_cast<AVFrame *>(context->av_frame);
+        av_frame_free(&frame);
+        delete context;
+    }
+    ClearPlanePools();
+}
+
+void VideoFramePool::Attach(AVCodecContext *codecContext) {
+    codecContext->opaque      = this;
+    codecContext->get_buffer2 = GetBuffer2;
+}
+
+FFmpegBufferContext *VideoFramePool::Obtain() {
+    {
+        LOCK_GUARD lock(mLock);
+        mStat.obtain_count++;
+        if (!mFreeFrames.empty()) {
+            FFmpegBufferContext *context = mFreeFrames.back();
+            mFreeFrames.pop_back();
+            mStat.hit_count++;
+            mRefs++;
+            mInUse++;
+            mStat.peak_in_use = std::max(mStat.peak_in_use, mInUse);
+            return context;
+        }
+    }
+    AVFrame *frame = av_frame_alloc();
+    if (!frame) {
+        return nullptr;
+    }
+    auto *context = new FFmpegBufferContext{
+            .opaque = this,
+            .av_frame = frame,
+            .release_frame = ReleaseFrame,
+    };
+    LOCK_GUARD lock(mLock);
+    mRefs++;
+    mInUse++;
+    mStat.peak_in_use = std::max(mStat.peak_in_use, mInUse);
+    return context;
+}
+
+FramePoolStat VideoFramePool::GetStat() {
+    LOCK_GUARD lock(mLock);
+    FramePoolStat stat = mStat;
+    stat.plane_alloc_count = mPlaneAllocs.load();
+    return stat;
+}
+
+void VideoFramePool::Release() {
+    std::vector<FFmpegBufferContext *> frames;
+    bool last;
+    {
+        LOCK_GUARD lock(mLock);
+        NEXT_LOGD(TAG, "obtain=%lld, hit=%lld, get_buffer=%lld, plane_alloc=%lld, "
+                       "fallback=%lld, peak=%d, in_use=%d\n",
+                  (long long) mStat.obtain_count, (long long) mStat.hit_count,
+                  (long long) mStat.get_buffer_count, (long long) mPlaneAllocs.load(),
+                  (long long) mStat.fallback_count, mStat.peak_in_use, mInUse);
+        bReleased = true;
+        frames.swap(mFreeFrames);
+        // buffers still held by frames keep their pool alive
+        ClearPlanePools();
+        last = Unref();
+    }
+    for (auto *context : frames) {
+        auto *frame = reinterpret_cast<AVFrame *>(context->av_frame);
+        av_frame_free(&frame);
+        delete context;
+    }
+    if (last) {
+        delete this;
+    }
+}
+
+void VideoFramePool::ReleaseFrame(FFmpegBufferContext *context) {
+    if (context) {
+        reinterpret_cast<VideoFramePool *>(context->opaque)->Recycle(context);
+    }
+}
+
+void VideoFramePool::Recycle(FFmpegBufferContext *context) {
+    auto *frame = reinterpret_cast<AVFrame *>(context->av_frame);
+    // unref outside the lock, the planes go back to their pools
+    av_frame_unref(frame);
+    bool keep;
+    bool last;
+    {
+        LOCK_GUARD lock(mLock);
+        mInUse = std::max(mInUse - 1, 0);
+        keep = !bReleased && static_cast<int>(mFreeFrames.size()) < mMaxSize;
+        if (keep) {
+            mFreeFrames.push_back(context);
+        }
+        last = Unref();
+    }
+    if (!keep) {
+        av_frame_free(&frame);
+        delete context;
+    }
+    if (last) {
+        delete this;
+    }
+}
+
+bool VideoFramePool::Unref() {
+    return --mRefs == 0;
+}
+
+int VideoFramePool::GetBuffer2(AVCodecContext *codecContext, AVFrame *frame, int flags) {
+    auto *pool = reinterpret_cast<VideoFramePool *>(codecContext->opaque);
+    const AVPixFmtDescriptor *desc =
+            av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    // palettes, hardware surfaces and codecs writing their own strides keep the default
+    if (!pool || !desc || (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL)) ||
+        !(codecContext->codec->capabilities & AV_CODEC_CAP_DR1)) {
+        if (pool) {
+            LOCK_GUARD lock(pool->mLock);
+            pool->mStat.fallback_count++;
+        }
+        return avcodec_default_get_buffer2(codecContext, frame, flags);
+    }
+    return pool->GetBuffer(codecContext, frame);
+}
+
+AVBufferRef *VideoFramePool::AllocPlane(void *opaque, size_t size) {
+    // called by av_buffer_pool_get only when the pool is empty
+    reinterpret_cast<VideoFramePool *>(opaque)->mPlaneAllocs++;
+    return av_buffer_alloc(size);
+}
+
+int VideoFramePool::GetBuffer(AVCodecContext *codecContext, AVFrame *frame) {
+    LOCK_GUARD lock(mLock);
+    int ret = UpdatePlanePools(codecContext, frame);
+    if (ret < 0) {
+        return ret;
+    }
+    mStat.get_buffer_count++;
+    memset(frame->data, 0, sizeof(frame->data));
+    for (int i = 0; i < mPlanes; i++) {
+        frame->buf[i] = av_buffer_pool_get(mPlanePools[i]);
+        if (!frame->buf[i]) {
+            av_frame_unref(frame);
+            return AVERROR(ENOMEM);
+        }
+        frame->data[i]     = frame->buf[i]->data;
+        frame->linesize[i] = mLinesize[i];
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+int VideoFramePool::UpdatePlanePools(AVCodecContext *codecContext, AVFrame *frame) {
+    if (frame->format == mFormat && frame->width == mWidth && frame->height == mHeight) {
+        return 0;
+    }
+    ClearPlanePools();
+
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    int width  = frame->width;
+    int height = frame->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecContext, &width, &height, linesizeAlign);
+
+    // widen until every stride meets the codec's alignment
+    int linesize[FRAME_POOL_MAX_PLANES];
+    int unaligned;
+    do {
+        int ret = av_image_fill_linesizes(linesize, format, width);
+        if (ret < 0) {
+            return ret;
+        }
+        width += width & ~(width - 1);
+        unaligned = 0;
+        for (int i = 0; i < FRAME_POOL_MAX_PLANES; i++) {
+            unaligned |= linesize[i] % linesizeAlign[i];
+        }
+    } while (unaligned);
+
+    ptrdiff_t strides[FRAME_POOL_MAX_PLANES];
+    for (int i = 0; i < FRAME_POOL_MAX_PLANES; i++) {
+        strides[i] = linesize[i];
+    }
+    size_t sizes[FRAME_POOL_MAX_PLANES];
+    int ret = av_image_fill_plane_sizes(sizes, format, height, strides);
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < FRAME_POOL_MAX_PLANES && sizes[i] > 0; i++) {
+        mLinesize[i]   = linesize[i];
+        mPlaneSize[i]  = sizes[i] + PLANE_PADDING;
+        mPlanePools[i] = av_buffer_pool_init2(mPlaneSize[i], this, AllocPlane, nullptr);
+        if (!mPlanePools[i]) {
+            ClearPlanePools();
+            return AVERROR(ENOMEM);
+        }
+        mPlanes = i + 1;
+    }
+    mFormat = frame->format;
+    mWidth  = frame->width;
+    mHeight = frame->height;
+    NEXT_LOGD(TAG, "plane pools, fmt=%d, %dx%d, planes=%d\n",
+              mFormat, mWidth, mHeight, mPlanes);
+    return 0;
+}
+
+void VideoFramePool::ClearPlanePools() {
+    for (auto &pool : mPlanePools) {
+        av_buffer_pool_uninit(&pool);
+    }
+    mPlanes = 0;
+    mFormat = -1;
+    mWidth  = 0;
+    mHeight = 0;
+}
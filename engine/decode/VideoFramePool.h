@@ -0,0 +1,102 @@
+#ifndef VIDEO_FRAME_POOL_H
+#define VIDEO_FRAME_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "decode/common/MixedBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavcodec/avcodec.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define DEFAULT_FRAME_POOL_SIZE 32
+#define FRAME_POOL_MAX_PLANES 4
+
+struct FramePoolStat {
+    int64_t obtain_count = 0;
+    int64_t hit_count    = 0; // frame shells reused
+    int64_t get_buffer_count  = 0; // frames allocated by the codec
+    int64_t plane_alloc_count = 0; // plane buffers that went to the heap
+    int64_t fallback_count    = 0; // left to avcodec_default_get_buffer2
+    int peak_in_use = 0;
+};
+
+/**
+ * Output frames of the software video decoder: AVFrame shells with their
+ * FFmpegBufferContext, and the plane buffers the codec decodes into,
+ * handed out by get_buffer2 from per-plane AVBufferPools. Frames are
+ * released by the renderer after the decoder may be gone, so the pool
+ * lives until both the decoder and the last frame let go of it.
+ */
+class VideoFramePool {
+public:
+    static VideoFramePool *Create(int maxSize = DEFAULT_FRAME_POOL_SIZE);
+
+    // set get_buffer2 on the codec context, before avcodec_open2
+    void Attach(AVCodecContext *codecContext);
+
+    // empty frame, its release_frame unrefs it and recycles the context
+    FFmpegBufferContext *Obtain();
+
+    FramePoolStat GetStat();
+
+    // the decoder is done with the pool
+    void Release();
+
+    VideoFramePool(const VideoFramePool &) = delete;
+
+    VideoFramePool &operator=(const VideoFramePool &) = delete;
+
+private:
+    explicit VideoFramePool(int maxSize);
+
+    ~VideoFramePool();
+
+    static void ReleaseFrame(FFmpegBufferContext *context);
+
+    static int GetBuffer2(AVCodecContext *codecContext, AVFrame *frame, int flags);
+
+    static AVBufferRef *AllocPlane(void *opaque, size_t size);
+
+    void Recycle(FFmpegBufferContext *context);
+
+    int GetBuffer(AVCodecContext *codecContext, AVFrame *frame);
+
+    // must hold mLock
+    int UpdatePlanePools(AVCodecContext *codecContext, AVFrame *frame);
+
+    // must hold mLock
+    void ClearPlanePools();
+
+    // must hold mLock, true when the pool should be deleted
+    bool Unref();
+
+private:
+    int mMaxSize = DEFAULT_FRAME_POOL_SIZE;
+    int mInUse   = 0;
+    int mRefs    = 1; // the decoder and every frame handed out
+    bool bReleased = false;
+
+    std::mutex mLock;
+    FramePoolStat mStat;
+    std::atomic<int64_t> mPlaneAllocs {0};
+    std::vector<FFmpegBufferContext *> mFreeFrames;
+
+    // layout of the frames the plane pools were made for
+    int mFormat = -1;
+    int mWidth  = 0;
+    int mHeight = 0;
+    int mPlanes = 0;
+    int mLinesize[FRAME_POOL_MAX_PLANES] = {};
+    size_t mPlaneSize[FRAME_POOL_MAX_PLANES] = {};
+    AVBufferPool *mPlanePools[FRAME_POOL_MAX_PLANES] = {};
+};
+
+#endif //VIDEO_FRAME_POOL_H
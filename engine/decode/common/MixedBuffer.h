@@ -2,8 +2,10 @@
 #define MIXED_BUFFER_H
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "ObjectCache.h"
 #include "VideoCodecInfo.h"
 #include "NextDefine.h"
 
@@ -40,6 +42,7 @@ struct FFmpegBufferContext {
     void *opaque;
     void *av_frame;
 
+    // unref the frame, video frames give the context back to their pool too
     void (*release_frame)(FFmpegBufferContext *context);
 };
 
@@ -56,6 +59,8 @@ enum class BufferType {
 };
 
 struct VideoFrameMetadata {
+    OBJECT_CACHE_OPERATORS(VideoFrameMetadata)
+
     int width;
     int height;
 
@@ -137,6 +142,8 @@ struct VideoFormatMetadata {
 
 class MixedBuffer {
 public:
+    OBJECT_CACHE_OPERATORS(MixedBuffer)
+
     MixedBuffer(BufferType type, uint8_t *data, int size, bool own_data);
 
     MixedBuffer(BufferType type, int capacity);
@@ -0,0 +1,93 @@
+#ifndef OBJECT_CACHE_H
+#define OBJECT_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#define DEFAULT_OBJECT_CACHE_SIZE 64
+
+struct ObjectCacheStat {
+    int64_t alloc_count = 0; // went to the heap
+    int64_t reuse_count = 0; // served from the cache
+};
+
+/**
+ * Free list behind the class operator new/delete of objects made for every
+ * frame. Memory is kept as raw storage of sizeof(T), at most Capacity
+ * blocks, the rest goes back to the heap.
+ */
+template<typename T, int Capacity = DEFAULT_OBJECT_CACHE_SIZE>
+class ObjectCache {
+public:
+    static void *Allocate(size_t size) {
+        // a derived class doesn't fit the blocks
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        Cache &cache = Get();
+        {
+            std::lock_guard<std::mutex> lock(cache.lock);
+            if (!cache.blocks.empty()) {
+                void *ptr = cache.blocks.back();
+                cache.blocks.pop_back();
+                cache.stat.reuse_count++;
+                return ptr;
+            }
+            cache.stat.alloc_count++;
+        }
+        return ::operator new(size);
+    }
+
+    static void Free(void *ptr, size_t size) {
+        if (!ptr) {
+            return;
+        }
+        if (size == sizeof(T)) {
+            Cache &cache = Get();
+            std::lock_guard<std::mutex> lock(cache.lock);
+            if (static_cast<int>(cache.blocks.size()) < Capacity) {
+                cache.blocks.push_back(ptr);
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+    static ObjectCacheStat GetStat() {
+        Cache &cache = Get();
+        std::lock_guard<std::mutex> lock(cache.lock);
+        return cache.stat;
+    }
+
+private:
+    struct Cache {
+        Cache() {
+            blocks.reserve(Capacity);
+        }
+
+        std::mutex lock;
+        std::vector<void *> blocks;
+        ObjectCacheStat stat;
+    };
+
+    static Cache &Get() {
+        // never destroyed, objects may be freed by other statics at exit
+        static Cache *cache = new Cache();
+        return *cache;
+    }
+};
+
+// class operator new/delete of T backed by ObjectCache<T>
+#define OBJECT_CACHE_OPERATORS(T)                               \
+    static void *operator new(size_t size) {                    \
+        return ObjectCache<T>::Allocate(size);                  \
+    }                                                           \
+    static void operator delete(void *ptr, size_t size) {       \
+        ObjectCache<T>::Free(ptr, size);                        \
+    }
+
+#endif //OBJECT_CACHE_H
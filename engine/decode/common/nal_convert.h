@@ -1,6 +1,7 @@
 #ifndef NAL_CONVERT_H
 #define NAL_CONVERT_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct H2645ConvertState {
@@ -0,0 +1,498 @@
+/**
+ * Note: hls variant selection and segment prefetch
+ * Date: 2026/10/18
+ */
+
+#include "AdaptiveIO.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CommonUtil.h"
+#include "NextLog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/mem.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define TAG "AdaptiveIO"
+
+AdaptiveIO::~AdaptiveIO() {
+    Close();
+}
+
+int AdaptiveIO::Open(const std::string &url, AVDictionary *options,
+                     const AVIOInterruptCB &interruptCb, int prefetch) {
+    mInterruptCb = interruptCb;
+    av_dict_copy(&mOptions, options, 0);
+    mPrefetch = std::min(std::max(prefetch, 1), ADAPTIVE_MAX_PREFETCH);
+
+    std::string text;
+    int ret = FetchText(url, text);
+    if (ret < 0) {
+        return ret;
+    }
+    if (!HlsPlaylist::IsPlaylist(text)) {
+        return AVERROR_INVALIDDATA;
+    }
+    std::vector<HlsVariant> infos;
+    if (HlsPlaylist::IsMaster(text)) {
+        ret = HlsPlaylist::ParseMaster(text, url, infos);
+        if (ret < 0) {
+            return ret;
+        }
+    } else {
+        HlsVariant info;
+        info.url = url;
+        infos.push_back(info);
+    }
+    int start = 0;
+    for (size_t i = 0; i < infos.size(); i++) {
+        Variant variant;
+        variant.info = infos[i];
+        mVariants.push_back(variant);
+        // the first variant of the master playlist is the default one
+        if (infos[i].order == 0) {
+            start = static_cast<int>(i);
+        }
+    }
+
+    for (auto &it : mVariants) {
+        it.compatible = HlsPlaylist::SameCodecs(it.info.codecs, infos[start].codecs);
+        if (!it.compatible) {
+            NEXT_LOGI(TAG, "skip variant %lld bps, codecs=%s\n",
+                      (long long) it.info.bandwidth, it.info.codecs.c_str());
+        }
+    }
+
+    Variant &variant = mVariants[start];
+    if (HlsPlaylist::IsMaster(text)) {
+        ret = FetchText(variant.info.url, text);
+    }
+    if (ret >= 0) {
+        ret = LoadVariant(variant, text);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+    mVariant = start;
+    mDuration = variant.segments.back().start_us + variant.segments.back().duration_us;
+
+    auto *buffer = static_cast<uint8_t *>(av_malloc(ADAPTIVE_AVIO_SIZE));
+    mAvioCtx = buffer ? avio_alloc_context(buffer, ADAPTIVE_AVIO_SIZE, 0, this,
+                                           ReadPacket, nullptr, nullptr) : nullptr;
+    if (!mAvioCtx) {
+        av_free(buffer);
+        return AVERROR(ENOMEM);
+    }
+    mAvioCtx->seekable = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        Schedule();
+    }
+    for (int i = 0; i < mPrefetch; i++) {
+        mWorkers.emplace_back(&AdaptiveIO::WorkerThread, this);
+    }
+    NEXT_LOGI(TAG, "open, variants=%zu, start=%lld bps, segments=%zu, prefetch=%d\n",
+              mVariants.size(), (long long) variant.info.bandwidth,
+              variant.segments.size(), mPrefetch);
+    return 0;
+}
+
+AVIOContext *AdaptiveIO::GetContext() {
+    return mAvioCtx;
+}
+
+int64_t AdaptiveIO::GetDuration() const {
+    return mDuration;
+}
+
+int AdaptiveIO::SeekTime(int64_t timeUs) {
+    std::lock_guard<std::mutex> lock(mLock);
+    const std::vector<HlsSegment> &segments = mVariants[mVariant].segments;
+    int index = FindSegment(mVariant, timeUs);
+    if (index < 0) {
+        index = static_cast<int>(segments.size()) - 1;
+    }
+    for (auto &slot : mSlots) {
+        slot->cancel = true;
+    }
+    mSlots.clear();
+    mNextTimeUs = segments[index].start_us;
+    Schedule();
+    NEXT_LOGI(TAG, "seek to %lld, segment=%d\n", (long long) timeUs, index);
+    return 0;
+}
+
+bool AdaptiveIO::TakeSwitch(AdaptiveStatistic &stat) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!bSwitchPending) {
+        return false;
+    }
+    bSwitchPending = false;
+    FillStatistic(stat);
+    return true;
+}
+
+void AdaptiveIO::GetStatistic(AdaptiveStatistic &stat) {
+    std::lock_guard<std::mutex> lock(mLock);
+    FillStatistic(stat);
+}
+
+void AdaptiveIO::GetCacheStatistic(IOCacheStatistic &stat) {
+    std::lock_guard<std::mutex> lock(mLock);
+    int64_t cached = 0;
+    for (auto &slot : mSlots) {
+        cached += static_cast<int64_t>(slot->data.size() - slot->read_pos);
+    }
+    stat.file_pos   = mReadBytes + cached;
+    stat.cache_size = cached;
+    stat.file_size  = -1;
+}
+
+void AdaptiveIO::Abort() {
+    std::lock_guard<std::mutex> lock(mLock);
+    bAbort = true;
+    mCond.notify_all();
+}
+
+void AdaptiveIO::Close() {
+    Abort();
+    for (auto &worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+    if (mAvioCtx) {
+        av_freep(&mAvioCtx->buffer);
+        avio_context_free(&mAvioCtx);
+    }
+    av_dict_free(&mOptions);
+    mSlots.clear();
+}
+
+int AdaptiveIO::ReadPacket(void *opaque, uint8_t *buf, int size) {
+    return static_cast<AdaptiveIO *>(opaque)->Read(buf, size);
+}
+
+int AdaptiveIO::InterruptCallback(void *opaque) {
+    auto *transfer = static_cast<Transfer *>(opaque);
+    AdaptiveIO *io = transfer->io;
+    if (io->bAbort || (transfer->slot && transfer->slot->cancel)) {
+        return 1;
+    }
+    return io->mInterruptCb.callback ? io->mInterruptCb.callback(io->mInterruptCb.opaque) : 0;
+}
+
+int AdaptiveIO::Read(uint8_t *buf, int size) {
+    std::unique_lock<std::mutex> lock(mLock);
+    while (!bAbort) {
+        if (mSlots.empty()) {
+            return AVERROR_EOF;
+        }
+        Slot &front = *mSlots.front();
+        if (front.read_pos < front.data.size()) {
+            if (front.read_pos == 0 && front.variant != mReadVariant) {
+                if (mReadVariant >= 0) {
+                    mSwitchCount++;
+                    mSwitchReason = front.reason;
+                    bSwitchPending = true;
+                }
+                mReadVariant = front.variant;
+            }
+            int len = static_cast<int>(std::min(front.data.size() - front.read_pos, (size_t) size));
+            memcpy(buf, front.data.data() + front.read_pos, len);
+            front.read_pos += len;
+            mReadBytes += len;
+            return len;
+        }
+        if (front.done) {
+            mSlots.pop_front();
+            Schedule();
+            continue;
+        }
+        if (front.error < 0) {
+            // nothing of the segment was returned, it may come from any variant
+            if (front.read_pos > 0 || front.retry >= ADAPTIVE_MAX_RETRY) {
+                NEXT_LOGE(TAG, "segment error, ret=%d\n", front.error);
+                return front.error;
+            }
+            // retry from the lowest variant having the segment, else from the same one
+            for (size_t i = 0; i < mVariants.size(); i++) {
+                int variant = static_cast<int>(i);
+                if (variant == front.variant) {
+                    break;
+                }
+                int index = mVariants[i].compatible && mVariants[i].state == PLAYLIST_READY
+                            ? FindSegment(variant, front.segment.start_us) : -1;
+                if (index >= 0) {
+                    front.variant = variant;
+                    front.reason  = ADAPTIVE_SWITCH_ERROR;
+                    front.segment = mVariants[i].segments[index];
+                    mVariant = variant;
+                    break;
+                }
+            }
+            NEXT_LOGW(TAG, "segment error, ret=%d, retry=%d\n", front.error, front.retry);
+            front.retry++;
+            front.error   = 0;
+            front.started = false;
+            mCond.notify_all();
+        }
+        mCond.wait(lock);
+    }
+    return AVERROR_EXIT;
+}
+
+void AdaptiveIO::WorkerThread() {
+    std::unique_lock<std::mutex> lock(mLock);
+    while (!bAbort) {
+        if (!mPlaylistJobs.empty()) {
+            int index = mPlaylistJobs.front();
+            mPlaylistJobs.pop_front();
+            Variant variant;
+            variant.info = mVariants[index].info;
+            lock.unlock();
+            std::string text;
+            int ret = FetchText(variant.info.url, text);
+            if (ret >= 0) {
+                ret = LoadVariant(variant, text);
+            }
+            lock.lock();
+            if (ret < 0) {
+                NEXT_LOGW(TAG, "variant %d unusable, ret=%d\n", index, ret);
+                mVariants[index].state = PLAYLIST_FAILED;
+            } else {
+                mVariants[index].segments.swap(variant.segments);
+                mVariants[index].state = PLAYLIST_READY;
+            }
+            continue;
+        }
+        std::shared_ptr<Slot> slot;
+        for (auto &it : mSlots) {
+            if (!it->started) {
+                slot = it;
+                break;
+            }
+        }
+        if (!slot) {
+            mCond.wait(lock);
+            continue;
+        }
+        slot->started = true;
+        lock.unlock();
+        Download(slot);
+        lock.lock();
+    }
+}
+
+int AdaptiveIO::FetchText(const std::string &url, std::string &text) {
+    Transfer transfer;
+    transfer.io = this;
+    AVIOInterruptCB cb = {InterruptCallback, &transfer};
+    AVDictionary *opts = nullptr;
+    av_dict_copy(&opts, mOptions, 0);
+    AVIOContext *ctx = nullptr;
+    int ret = avio_open2(&ctx, url.c_str(), AVIO_FLAG_READ, &cb, &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        NEXT_LOGE(TAG, "open playlist error, ret=%d\n", ret);
+        return ret;
+    }
+    text.clear();
+    char chunk[4096];
+    while (text.size() < ADAPTIVE_MAX_PLAYLIST_SIZE) {
+        int len = avio_read(ctx, reinterpret_cast<unsigned char *>(chunk), sizeof(chunk));
+        if (len == AVERROR_EOF || len == 0) {
+            break;
+        }
+        if (len < 0) {
+            ret = len;
+            break;
+        }
+        text.append(chunk, len);
+    }
+    avio_closep(&ctx);
+    return ret < 0 ? ret : 0;
+}
+
+int AdaptiveIO::LoadVariant(Variant &variant, const std::string &text) {
+    variant.segments.clear();
+    int ret = HlsPlaylist::ParseMedia(text, variant.info.url, variant.segments);
+    variant.state = ret < 0 ? PLAYLIST_FAILED : PLAYLIST_READY;
+    return ret;
+}
+
+void AdaptiveIO::Download(const std::shared_ptr<Slot> &slot) {
+    Transfer transfer;
+    transfer.io = this;
+    transfer.slot = slot;
+    AVIOInterruptCB cb = {InterruptCallback, &transfer};
+    AVDictionary *opts = nullptr;
+    av_dict_copy(&opts, mOptions, 0);
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        url = slot->segment.url;
+        BeginTransfer();
+    }
+
+    AVIOContext *ctx = nullptr;
+    int ret = avio_open2(&ctx, url.c_str(), AVIO_FLAG_READ, &cb, &opts);
+    av_dict_free(&opts);
+    std::vector<uint8_t> chunk(ADAPTIVE_CHUNK_SIZE);
+    while (ret >= 0) {
+        int len = avio_read(ctx, chunk.data(), static_cast<int>(chunk.size()));
+        if (len == AVERROR_EOF || len == 0) {
+            break;
+        }
+        if (len < 0) {
+            ret = len;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(mLock);
+        if (slot->cancel) {
+            break;
+        }
+        slot->data.insert(slot->data.end(), chunk.data(), chunk.data() + len);
+        mSampleBytes += len;
+        mCond.notify_all();
+    }
+    avio_closep(&ctx);
+
+    std::lock_guard<std::mutex> lock(mLock);
+    bool ok = ret >= 0 && !slot->cancel;
+    EndTransfer(ok);
+    if (!slot->cancel) {
+        slot->done  = ret >= 0;
+        slot->error = ret >= 0 ? 0 : ret;
+    }
+    mCond.notify_all();
+}
+
+void AdaptiveIO::Schedule() {
+    while (static_cast<int>(mSlots.size()) < mPrefetch) {
+        int reason = ADAPTIVE_SWITCH_NONE;
+        int variant = ChooseVariant(&reason);
+        int index = FindSegment(variant, mNextTimeUs);
+        if (index < 0) {
+            break;
+        }
+        if (variant != mVariant) {
+            NEXT_LOGI(TAG, "switch %lld -> %lld bps, reason=%d, estimate=%lld, buffer=%lldms\n",
+                      (long long) mVariants[mVariant].info.bandwidth,
+                      (long long) mVariants[variant].info.bandwidth, reason,
+                      (long long) mEstimator.GetEstimate(), (long long) BufferedUs() / 1000);
+            mVariant = variant;
+        }
+        std::shared_ptr<Slot> slot(new Slot());
+        slot->variant = variant;
+        slot->reason  = reason;
+        slot->segment = mVariants[variant].segments[index];
+        mNextTimeUs = slot->segment.start_us + slot->segment.duration_us;
+        mSlots.push_back(slot);
+    }
+    mCond.notify_all();
+}
+
+int AdaptiveIO::ChooseVariant(int *reason) {
+    int64_t estimate = mEstimator.GetEstimate();
+    if (estimate <= 0 || mVariants.size() < 2) {
+        return mVariant;
+    }
+    bool lowBuffer = BufferedUs() < ADAPTIVE_LOW_BUFFER_US;
+    double usable = static_cast<double>(estimate)
+                    * (lowBuffer ? ADAPTIVE_LOW_BUFFER_FACTOR : ADAPTIVE_SAFETY_FACTOR);
+    int target = -1;
+    for (size_t i = 0; i < mVariants.size(); i++) {
+        if (mVariants[i].compatible && mVariants[i].state != PLAYLIST_FAILED
+            && mVariants[i].info.bandwidth <= usable) {
+            target = static_cast<int>(i);
+        }
+    }
+    if (target < 0) {
+        // nothing fits, the lowest compatible one
+        for (size_t i = 0; i < mVariants.size() && target < 0; i++) {
+            if (mVariants[i].compatible && mVariants[i].state != PLAYLIST_FAILED) {
+                target = static_cast<int>(i);
+            }
+        }
+    }
+    if (target < 0 || (target > mVariant && lowBuffer)) {
+        target = mVariant;
+    }
+    if (target == mVariant) {
+        return mVariant;
+    }
+    // load the playlist now, switch at a later segment
+    if (mVariants[target].state != PLAYLIST_READY) {
+        if (mVariants[target].state == PLAYLIST_NONE) {
+            mVariants[target].state = PLAYLIST_LOADING;
+            mPlaylistJobs.push_back(target);
+        }
+        return mVariant;
+    }
+    *reason = target > mVariant ? ADAPTIVE_SWITCH_UP
+                                : (lowBuffer ? ADAPTIVE_SWITCH_LOW_BUFFER : ADAPTIVE_SWITCH_DOWN);
+    return target;
+}
+
+int AdaptiveIO::FindSegment(int variant, int64_t timeUs) const {
+    const std::vector<HlsSegment> &segments = mVariants[variant].segments;
+    auto it = std::upper_bound(segments.begin(), segments.end(), timeUs + ADAPTIVE_TIME_TOLERANCE,
+                               [](int64_t time, const HlsSegment &segment) {
+                                   return time < segment.start_us + segment.duration_us;
+                               });
+    return it == segments.end() ? -1 : static_cast<int>(it - segments.begin());
+}
+
+int64_t AdaptiveIO::BufferedUs() const {
+    int64_t buffered = 0;
+    for (auto &slot : mSlots) {
+        if (slot->done && !slot->data.empty()) {
+            buffered += slot->segment.duration_us
+                        * static_cast<int64_t>(slot->data.size() - slot->read_pos)
+                        / static_cast<int64_t>(slot->data.size());
+        }
+    }
+    return buffered;
+}
+
+void AdaptiveIO::FillStatistic(AdaptiveStatistic &stat) const {
+    int variant = mReadVariant >= 0 ? mReadVariant : mVariant;
+    stat.variant_index   = variant;
+    stat.variant_count   = static_cast<int>(mVariants.size());
+    stat.switch_count    = mSwitchCount;
+    stat.switch_reason   = mSwitchReason;
+    stat.variant_bitrate = variant >= 0 ? mVariants[variant].info.bandwidth : 0;
+    stat.width           = variant >= 0 ? mVariants[variant].info.width : 0;
+    stat.height          = variant >= 0 ? mVariants[variant].info.height : 0;
+    stat.bandwidth       = mEstimator.GetEstimate();
+    stat.buffer_us       = BufferedUs();
+}
+
+void AdaptiveIO::BeginTransfer() {
+    if (mActive++ == 0) {
+        mBusySince = SteadyTimeUs();
+    }
+}
+
+void AdaptiveIO::EndTransfer(bool sample) {
+    int64_t now = SteadyTimeUs();
+    if (--mActive == 0) {
+        mBusyUs += now - mBusySince;
+        mBusySince = now;
+    }
+    // parallel downloads share the link, measure all bytes over the busy time
+    int64_t busy = mBusyUs + (mActive > 0 ? now - mBusySince : 0);
+    if (sample && busy >= BANDWIDTH_MIN_SAMPLE_US) {
+        mEstimator.AddSample(mSampleBytes, busy);
+        mSampleBytes = 0;
+        mBusyUs      = 0;
+        mBusySince   = now;
+    }
+}
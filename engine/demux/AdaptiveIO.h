@@ -0,0 +1,172 @@
+#ifndef ADAPTIVE_IO_H
+#define ADAPTIVE_IO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BandwidthEstimator.h"
+#include "HlsPlaylist.h"
+#include "NextStructDefine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavformat/avio.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define ADAPTIVE_AVIO_SIZE (32 * 1024)
+#define ADAPTIVE_CHUNK_SIZE (64 * 1024)
+#define ADAPTIVE_MAX_PREFETCH 8
+#define ADAPTIVE_MAX_RETRY 2
+#define ADAPTIVE_MAX_PLAYLIST_SIZE (4 * 1024 * 1024)
+// below this much media downloaded ahead, trust half of the estimate and never switch up
+#define ADAPTIVE_LOW_BUFFER_US (4 * 1000 * 1000)
+#define ADAPTIVE_SAFETY_FACTOR 0.8
+#define ADAPTIVE_LOW_BUFFER_FACTOR 0.5
+// rounding of EXTINF when matching segments of two variants
+#define ADAPTIVE_TIME_TOLERANCE (10 * 1000)
+
+/**
+ * AVIOContext of a VOD HLS stream: the segments of the chosen variant
+ * concatenated into one MPEG-TS byte stream. The next segments are
+ * downloaded in parallel, each one from the variant picked by the
+ * throughput estimate and the downloaded buffer at the time it is
+ * scheduled. Variant playlists are loaded when first needed. Only the
+ * variants declaring the codecs of the default one are switched to, a
+ * decoder can't follow a codec change inside one stream.
+ */
+class AdaptiveIO {
+public:
+    ~AdaptiveIO();
+
+    // url of a master or media playlist, AVERROR_PATCHWELCOME for
+    // playlists that should be left to the hls demuxer
+    int Open(const std::string &url, AVDictionary *options,
+             const AVIOInterruptCB &interruptCb, int prefetch);
+
+    // owned by AdaptiveIO, not seekable by bytes
+    AVIOContext *GetContext();
+
+    int64_t GetDuration() const;
+
+    // restart at the segment containing timeUs, the demuxer must be flushed
+    int SeekTime(int64_t timeUs);
+
+    // true once after the demuxer reaches a segment of another variant
+    bool TakeSwitch(AdaptiveStatistic &stat);
+
+    void GetStatistic(AdaptiveStatistic &stat);
+
+    void GetCacheStatistic(IOCacheStatistic &stat);
+
+    void Abort();
+
+    void Close();
+
+private:
+    enum PlaylistState {
+        PLAYLIST_NONE,
+        PLAYLIST_LOADING,
+        PLAYLIST_READY,
+        PLAYLIST_FAILED
+    };
+
+    struct Variant {
+        HlsVariant info;
+        std::vector<HlsSegment> segments;
+        int state = PLAYLIST_NONE;
+        bool compatible = true; // same codecs as the default variant
+    };
+
+    struct Slot {
+        int variant = -1;
+        int reason  = ADAPTIVE_SWITCH_NONE; // why the variant was chosen
+        HlsSegment segment;
+        std::vector<uint8_t> data;
+        size_t read_pos = 0;
+        bool started    = false;
+        bool done       = false;
+        int error       = 0;
+        int retry       = 0;
+        std::atomic_bool cancel {false};
+    };
+
+    // what the interrupt callback of one transfer checks
+    struct Transfer {
+        AdaptiveIO *io = nullptr;
+        std::shared_ptr<Slot> slot;
+    };
+
+    static int ReadPacket(void *opaque, uint8_t *buf, int size);
+
+    static int InterruptCallback(void *opaque);
+
+    int Read(uint8_t *buf, int size);
+
+    void WorkerThread();
+
+    int FetchText(const std::string &url, std::string &text);
+
+    int LoadVariant(Variant &variant, const std::string &text);
+
+    void Download(const std::shared_ptr<Slot> &slot);
+
+    // the following are called with mLock held
+    void Schedule();
+
+    int ChooseVariant(int *reason);
+
+    int FindSegment(int variant, int64_t timeUs) const;
+
+    int64_t BufferedUs() const;
+
+    void FillStatistic(AdaptiveStatistic &stat) const;
+
+    void BeginTransfer();
+
+    // sample the estimator when a download completes
+    void EndTransfer(bool sample);
+
+private:
+    std::mutex mLock;
+    std::condition_variable mCond;
+    std::vector<std::thread> mWorkers;
+    std::atomic_bool bAbort {false};
+
+    AVIOContext *mAvioCtx = nullptr;
+    AVIOInterruptCB mInterruptCb {};
+    AVDictionary *mOptions = nullptr;
+    int mPrefetch = 1;
+
+    std::vector<Variant> mVariants;
+    std::deque<int> mPlaylistJobs;
+    int mVariant = -1; // of the last scheduled segment
+    int mReadVariant = -1; // of the bytes last returned to the demuxer
+    int64_t mDuration = 0;
+
+    // segments being read and prefetched, in playback order
+    std::deque<std::shared_ptr<Slot>> mSlots;
+    int64_t mNextTimeUs = 0; // start of the next segment to schedule
+    int64_t mReadBytes  = 0;
+
+    BandwidthEstimator mEstimator;
+    int mActive        = 0;
+    int64_t mBusySince = 0;
+    int64_t mBusyUs    = 0;
+    int64_t mSampleBytes = 0;
+
+    int mSwitchCount  = 0;
+    int mSwitchReason = ADAPTIVE_SWITCH_NONE;
+    bool bSwitchPending = false;
+};
+
+#endif //ADAPTIVE_IO_H
@@ -0,0 +1,40 @@
+/**
+ * Note: throughput estimate of segment downloads
+ * Date: 2026/10/18
+ */
+
+#include "BandwidthEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+void BandwidthEstimator::Reset() {
+    mFast = Ewma(BANDWIDTH_FAST_HALF_LIFE);
+    mSlow = Ewma(BANDWIDTH_SLOW_HALF_LIFE);
+}
+
+void BandwidthEstimator::AddSample(int64_t bytes, int64_t durationUs) {
+    if (bytes <= 0 || durationUs < BANDWIDTH_MIN_SAMPLE_US) {
+        return;
+    }
+    double seconds = static_cast<double>(durationUs) / 1000000;
+    double bps = static_cast<double>(bytes) * 8 / seconds;
+    mFast.Add(seconds, bps);
+    mSlow.Add(seconds, bps);
+}
+
+int64_t BandwidthEstimator::GetEstimate() const {
+    return static_cast<int64_t>(std::min(mFast.Get(), mSlow.Get()));
+}
+
+void BandwidthEstimator::Ewma::Add(double weight, double value) {
+    double alpha = std::pow(0.5, weight / half_life);
+    estimate = value * (1 - alpha) + estimate * alpha;
+    total_weight += weight;
+}
+
+double BandwidthEstimator::Ewma::Get() const {
+    // the average starts at zero, remove that bias
+    double zeroFactor = 1 - std::pow(0.5, total_weight / half_life);
+    return zeroFactor > 0 ? estimate / zeroFactor : 0;
+}
@@ -0,0 +1,44 @@
+#ifndef BANDWIDTH_ESTIMATOR_H
+#define BANDWIDTH_ESTIMATOR_H
+
+#include <cstdint>
+
+// half-lives in seconds of transfer time
+#define BANDWIDTH_FAST_HALF_LIFE 2.0
+#define BANDWIDTH_SLOW_HALF_LIFE 5.0
+// samples shorter than this are mostly latency
+#define BANDWIDTH_MIN_SAMPLE_US (50 * 1000)
+
+/**
+ * Throughput estimate of segment downloads. Two moving averages weighted
+ * by transfer time, the lower one wins: drops are followed quickly and
+ * short bursts don't cause an up switch.
+ */
+class BandwidthEstimator {
+public:
+    void Reset();
+
+    // bytes transferred while busy for durationUs
+    void AddSample(int64_t bytes, int64_t durationUs);
+
+    // bps, 0 before the first sample
+    int64_t GetEstimate() const;
+
+private:
+    struct Ewma {
+        explicit Ewma(double halfLife) : half_life(halfLife) {}
+
+        double half_life    = 0;
+        double estimate     = 0;
+        double total_weight = 0;
+
+        void Add(double weight, double value);
+
+        double Get() const;
+    };
+
+    Ewma mFast {BANDWIDTH_FAST_HALF_LIFE};
+    Ewma mSlow {BANDWIDTH_SLOW_HALF_LIFE};
+};
+
+#endif //BANDWIDTH_ESTIMATOR_H
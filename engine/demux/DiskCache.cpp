@@ -0,0 +1,411 @@
+/**
+ * Note: block cache of remote sources on disk
+ * Date: 2026/10/18
+ */
+
+#include "DiskCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <functional>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "NextLog.h"
+
+#define TAG "DiskCache"
+
+#define DISK_CACHE_MAGIC 0x4E444B43 // NDKC
+#define DATA_SUFFIX  ".data"
+#define INDEX_SUFFIX ".idx"
+
+struct DiskCacheHeader {
+    uint32_t magic      = DISK_CACHE_MAGIC;
+    uint32_t version    = DISK_CACHE_VERSION;
+    uint32_t block_size = DISK_CACHE_BLOCK_SIZE;
+    uint32_t url_len    = 0;
+    int64_t file_size   = 0;
+    int64_t block_count = 0;
+};
+
+DiskCache::DiskCache(const std::string &cacheDir, int64_t maxSize)
+        : mCacheDir(cacheDir), mMaxSize(maxSize) {
+    if (!mCacheDir.empty() && mCacheDir.back() != '/') {
+        mCacheDir += '/';
+    }
+    std::lock_guard<std::mutex> lock(mLock);
+    LoadEntries();
+    Evict();
+}
+
+DiskCache::~DiskCache() {
+    std::vector<std::shared_ptr<DiskCacheEntry>> entries;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        for (auto &it : mEntries) {
+            entries.push_back(it.second);
+        }
+    }
+    for (auto &entry : entries) {
+        SaveIndex(entry);
+        if (entry->fd >= 0) {
+            close(entry->fd);
+            entry->fd = -1;
+        }
+    }
+}
+
+std::shared_ptr<DiskCacheEntry> DiskCache::Acquire(const std::string &url, int64_t fileSize) {
+    if (mCacheDir.empty() || fileSize <= 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mEntries.find(url);
+    if (it != mEntries.end() && it->second->file_size != fileSize) {
+        NEXT_LOGI(TAG, "source changed, size %lld -> %lld\n",
+                  (long long) it->second->file_size, (long long) fileSize);
+        if (it->second->ref_count > 0) {
+            return nullptr;
+        }
+        RemoveEntry(url);
+        it = mEntries.end();
+    }
+
+    std::shared_ptr<DiskCacheEntry> entry;
+    if (it == mEntries.end()) {
+        entry = std::make_shared<DiskCacheEntry>();
+        entry->url       = url;
+        entry->name      = EntryName(url);
+        entry->file_size = fileSize;
+        entry->blocks.resize(static_cast<size_t>(
+                (fileSize + DISK_CACHE_BLOCK_SIZE - 1) / DISK_CACHE_BLOCK_SIZE));
+        mEntries[url] = entry;
+    } else {
+        entry = it->second;
+    }
+
+    if (entry->fd < 0) {
+        entry->fd = open(DataPath(entry->name).c_str(), O_RDWR | O_CREAT, 0644);
+        if (entry->fd < 0) {
+            NEXT_LOGE(TAG, "open data file fail: %s\n", strerror(errno));
+            return nullptr;
+        }
+    }
+    entry->ref_count++;
+    entry->access = time(nullptr);
+    return entry;
+}
+
+void DiskCache::Release(const std::shared_ptr<DiskCacheEntry> &entry) {
+    if (!entry) {
+        return;
+    }
+    SaveIndex(entry);
+    std::lock_guard<std::mutex> lock(mLock);
+    if (--entry->ref_count <= 0 && entry->fd >= 0) {
+        close(entry->fd);
+        entry->fd = -1;
+    }
+    Evict();
+}
+
+int DiskCache::ReadBlock(const std::shared_ptr<DiskCacheEntry> &entry, int64_t index, uint8_t *buf) {
+    std::lock_guard<std::mutex> lock(mLock);
+    int size = BlockSize(*entry, index);
+    if (size <= 0 || !entry->blocks[index] || entry->fd < 0) {
+        mStat.miss_blocks++;
+        return -1;
+    }
+    ssize_t ret = pread(entry->fd, buf, size, index * DISK_CACHE_BLOCK_SIZE);
+    if (ret != size) {
+        // the data file was damaged, fetch the block again
+        entry->blocks[index] = false;
+        entry->cached -= size;
+        mStat.total_bytes -= size;
+        mStat.miss_blocks++;
+        return -1;
+    }
+    entry->access = time(nullptr);
+    mStat.hit_blocks++;
+    mStat.hit_bytes += size;
+    return size;
+}
+
+void DiskCache::WriteBlock(const std::shared_ptr<DiskCacheEntry> &entry, int64_t index,
+                           const uint8_t *buf, int size) {
+    bool save;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mStat.miss_bytes += size;
+        if (size != BlockSize(*entry, index) || entry->blocks[index] || entry->fd < 0) {
+            return;
+        }
+        if (pwrite(entry->fd, buf, size, index * DISK_CACHE_BLOCK_SIZE) != size) {
+            NEXT_LOGW(TAG, "write block %lld fail: %s\n", (long long) index, strerror(errno));
+            return;
+        }
+        entry->blocks[index] = true;
+        entry->cached += size;
+        mStat.total_bytes += size;
+        save = ++entry->dirty_blocks >= DISK_CACHE_INDEX_FLUSH;
+        if (mStat.total_bytes > mMaxSize) {
+            Evict();
+        }
+    }
+    // the syncs take long on flash, other readers of the cache don't wait for them
+    if (save) {
+        SaveIndex(entry);
+    }
+}
+
+int DiskCache::BlockSize(const DiskCacheEntry &entry, int64_t index) {
+    if (index < 0 || index >= (int64_t) entry.blocks.size()) {
+        return 0;
+    }
+    int64_t start = index * DISK_CACHE_BLOCK_SIZE;
+    return static_cast<int>(std::min((int64_t) DISK_CACHE_BLOCK_SIZE, entry.file_size - start));
+}
+
+DiskCacheStat DiskCache::GetStat() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mStat;
+}
+
+void DiskCache::Clear() {
+    std::lock_guard<std::mutex> lock(mLock);
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (it->second->ref_count > 0) {
+            ++it;
+            continue;
+        }
+        std::string url = (it++)->first;
+        RemoveEntry(url);
+    }
+}
+
+void DiskCache::LoadEntries() {
+    DIR *dir = opendir(mCacheDir.c_str());
+    if (!dir) {
+        return;
+    }
+    std::vector<std::string> files;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != nullptr) {
+        if (ent->d_name[0] != '.') {
+            files.emplace_back(ent->d_name);
+        }
+    }
+    closedir(dir);
+
+    size_t suffixLen = strlen(INDEX_SUFFIX);
+    for (auto &file : files) {
+        if (file.size() <= suffixLen
+            || file.compare(file.size() - suffixLen, suffixLen, INDEX_SUFFIX) != 0) {
+            continue;
+        }
+        std::string name = file.substr(0, file.size() - suffixLen);
+        auto entry = std::make_shared<DiskCacheEntry>();
+        if (!LoadIndex(name, *entry) || mEntries.count(entry->url) > 0) {
+            remove(IndexPath(name).c_str());
+            remove(DataPath(name).c_str());
+            continue;
+        }
+        mStat.total_bytes += entry->cached;
+        mEntries[entry->url] = entry;
+    }
+    // data without index and temp files left by a crash
+    for (auto &file : files) {
+        bool used = false;
+        for (auto &it : mEntries) {
+            if (file == it.second->name + DATA_SUFFIX || file == it.second->name + INDEX_SUFFIX) {
+                used = true;
+                break;
+            }
+        }
+        if (!used) {
+            remove((mCacheDir + file).c_str());
+        }
+    }
+    NEXT_LOGI(TAG, "load %zu entries, total=%lld\n", mEntries.size(),
+              (long long) mStat.total_bytes);
+}
+
+bool DiskCache::LoadIndex(const std::string &name, DiskCacheEntry &entry) {
+    FILE *fp = fopen(IndexPath(name).c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+    bool ok = false;
+    DiskCacheHeader header;
+    do {
+        if (fread(&header, sizeof(header), 1, fp) != 1 || header.magic != DISK_CACHE_MAGIC
+            || header.version != DISK_CACHE_VERSION || header.block_size != DISK_CACHE_BLOCK_SIZE
+            || header.file_size <= 0 || header.block_count
+               != (header.file_size + DISK_CACHE_BLOCK_SIZE - 1) / DISK_CACHE_BLOCK_SIZE) {
+            break;
+        }
+        entry.url.resize(header.url_len);
+        if (header.url_len > 0 && fread(&entry.url[0], 1, header.url_len, fp) != header.url_len) {
+            break;
+        }
+        std::vector<uint8_t> bitmap(static_cast<size_t>((header.block_count + 7) / 8));
+        if (fread(bitmap.data(), 1, bitmap.size(), fp) != bitmap.size()) {
+            break;
+        }
+        entry.name      = name;
+        entry.file_size = header.file_size;
+        entry.blocks.resize(static_cast<size_t>(header.block_count));
+        for (int64_t i = 0; i < header.block_count; i++) {
+            if (bitmap[i / 8] & (1 << (i % 8))) {
+                entry.blocks[i] = true;
+                entry.cached += BlockSize(entry, i);
+            }
+        }
+        ok = entry.url.size() == header.url_len;
+    } while (false);
+    fclose(fp);
+
+    struct stat st {};
+    if (ok && stat(IndexPath(name).c_str(), &st) == 0) {
+        entry.access = static_cast<int64_t>(st.st_mtime);
+    }
+    return ok;
+}
+
+bool DiskCache::SaveIndex(const std::shared_ptr<DiskCacheEntry> &entry) {
+    // one save at a time, so an older bitmap never replaces a newer one
+    std::lock_guard<std::mutex> saveLock(mSaveLock);
+    DiskCacheHeader header;
+    std::vector<uint8_t> bitmap;
+    std::string path;
+    int dirty;
+    int fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        dirty = entry->dirty_blocks;
+        if (dirty <= 0 || entry->removed) {
+            return true;
+        }
+        header.url_len     = static_cast<uint32_t>(entry->url.size());
+        header.file_size   = entry->file_size;
+        header.block_count = static_cast<int64_t>(entry->blocks.size());
+        bitmap.resize(static_cast<size_t>((header.block_count + 7) / 8), 0);
+        for (size_t i = 0; i < entry->blocks.size(); i++) {
+            if (entry->blocks[i]) {
+                bitmap[i / 8] |= (1 << (i % 8));
+            }
+        }
+        path = IndexPath(entry->name);
+        // the entry may be closed while syncing
+        if (entry->fd >= 0) {
+            fd = dup(entry->fd);
+        }
+    }
+
+    // index must never mark data that isn't on disk yet
+    if (fd >= 0) {
+        fdatasync(fd);
+        close(fd);
+    }
+    std::string tmpPath = path + ".tmp";
+    FILE *fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+              && fwrite(entry->url.data(), 1, entry->url.size(), fp) == entry->url.size()
+              && fwrite(bitmap.data(), 1, bitmap.size(), fp) == bitmap.size()
+              && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    ok = (fclose(fp) == 0) && ok;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    // an evicted entry must not get its index back
+    if (!ok || entry->removed || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        if (!entry->removed) {
+            NEXT_LOGW(TAG, "save index fail: %s\n", path.c_str());
+        }
+        remove(tmpPath.c_str());
+        return false;
+    }
+    // blocks written during the save stay dirty
+    entry->dirty_blocks -= dirty;
+    return true;
+}
+
+void DiskCache::RemoveEntry(const std::string &url) {
+    auto it = mEntries.find(url);
+    if (it == mEntries.end()) {
+        return;
+    }
+    std::shared_ptr<DiskCacheEntry> entry = it->second;
+    entry->removed = true;
+    if (entry->fd >= 0) {
+        close(entry->fd);
+        entry->fd = -1;
+    }
+    remove(IndexPath(entry->name).c_str());
+    remove(DataPath(entry->name).c_str());
+    mStat.total_bytes -= entry->cached;
+    mEntries.erase(it);
+}
+
+void DiskCache::Evict() {
+    // sources opened but never cached only leave an index behind
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (it->second->ref_count > 0 || it->second->cached > 0) {
+            ++it;
+            continue;
+        }
+        std::string url = (it++)->first;
+        RemoveEntry(url);
+    }
+    while (mStat.total_bytes > mMaxSize) {
+        std::shared_ptr<DiskCacheEntry> oldest;
+        for (auto &it : mEntries) {
+            if (it.second->ref_count > 0) {
+                continue;
+            }
+            if (!oldest || it.second->access < oldest->access) {
+                oldest = it.second;
+            }
+        }
+        // everything left is being played
+        if (!oldest) {
+            break;
+        }
+        NEXT_LOGI(TAG, "evict %s, size=%lld\n", oldest->name.c_str(), (long long) oldest->cached);
+        mStat.evict_bytes += oldest->cached;
+        RemoveEntry(oldest->url);
+    }
+}
+
+std::string DiskCache::EntryName(const std::string &url) const {
+    char name[32] = {0};
+    size_t hash = std::hash<std::string>()(url);
+    // different urls may share a hash
+    for (int i = 0;; i++) {
+        snprintf(name, sizeof(name), "%016zx_%d", hash, i);
+        bool used = false;
+        for (auto &it : mEntries) {
+            if (it.second->name == name) {
+                used = true;
+                break;
+            }
+        }
+        if (!used) {
+            return name;
+        }
+    }
+}
+
+std::string DiskCache::DataPath(const std::string &name) const {
+    return mCacheDir + name + DATA_SUFFIX;
+}
+
+std::string DiskCache::IndexPath(const std::string &name) const {
+    return mCacheDir + name + INDEX_SUFFIX;
+}
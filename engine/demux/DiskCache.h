@@ -0,0 +1,97 @@
+#ifndef DISK_CACHE_H
+#define DISK_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define DISK_CACHE_VERSION     1
+#define DISK_CACHE_BLOCK_SIZE  (256 * 1024)
+#define DISK_CACHE_MAX_SIZE    (512LL * 1024 * 1024)
+// blocks written between two index saves
+#define DISK_CACHE_INDEX_FLUSH 16
+
+struct DiskCacheStat {
+    int64_t hit_bytes   = 0;
+    int64_t miss_bytes  = 0;
+    int64_t hit_blocks  = 0;
+    int64_t miss_blocks = 0;
+    int64_t evict_bytes = 0;
+    int64_t total_bytes = 0;
+};
+
+// one cached source: sparse data file plus a block bitmap in the index file
+struct DiskCacheEntry {
+    std::string url;
+    std::string name;
+    int fd             = -1;
+    int ref_count      = 0;
+    int dirty_blocks   = 0;
+    int64_t file_size  = 0;
+    int64_t cached     = 0;
+    int64_t access     = 0;
+    bool removed       = false;
+    std::vector<bool> blocks;
+};
+
+/**
+ * Block level cache of remote sources on disk, shared by every DiskCacheIO.
+ * Data is synced before the index that marks it, and the index is replaced
+ * by rename, so a crash loses at most the blocks after the last index save.
+ * Unused entries are evicted in LRU order once the total size is exceeded.
+ */
+class DiskCache {
+public:
+    explicit DiskCache(const std::string &cacheDir, int64_t maxSize = DISK_CACHE_MAX_SIZE);
+
+    ~DiskCache();
+
+    // nullptr if the cache can't be used, a size mismatch drops old data
+    std::shared_ptr<DiskCacheEntry> Acquire(const std::string &url, int64_t fileSize);
+
+    void Release(const std::shared_ptr<DiskCacheEntry> &entry);
+
+    // bytes read, or -1 when the block isn't cached
+    int ReadBlock(const std::shared_ptr<DiskCacheEntry> &entry, int64_t index, uint8_t *buf);
+
+    void WriteBlock(const std::shared_ptr<DiskCacheEntry> &entry, int64_t index,
+                    const uint8_t *buf, int size);
+
+    static int BlockSize(const DiskCacheEntry &entry, int64_t index);
+
+    DiskCacheStat GetStat();
+
+    void Clear();
+
+private:
+    void LoadEntries();
+
+    bool LoadIndex(const std::string &name, DiskCacheEntry &entry);
+
+    // must not hold mLock, the syncs run outside of it
+    bool SaveIndex(const std::shared_ptr<DiskCacheEntry> &entry);
+
+    // must hold mLock
+    void RemoveEntry(const std::string &url);
+
+    void Evict();
+
+    std::string EntryName(const std::string &url) const;
+
+    std::string DataPath(const std::string &name) const;
+
+    std::string IndexPath(const std::string &name) const;
+
+private:
+    std::mutex mLock;
+    std::mutex mSaveLock;
+    std::string mCacheDir;
+    int64_t mMaxSize = DISK_CACHE_MAX_SIZE;
+    DiskCacheStat mStat;
+    std::map<std::string, std::shared_ptr<DiskCacheEntry>> mEntries;
+};
+
+#endif //DISK_CACHE_H
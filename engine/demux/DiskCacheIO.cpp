@@ -0,0 +1,199 @@
+/**
+ * Note: avio layer backed by the disk cache
+ * Date: 2026/10/18
+ */
+
+#include "DiskCacheIO.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "NextLog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/mem.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define TAG "DiskCacheIO"
+
+DiskCacheIO::DiskCacheIO(std::shared_ptr<DiskCache> cache)
+        : mCache(std::move(cache)) {
+}
+
+DiskCacheIO::~DiskCacheIO() {
+    Close();
+}
+
+int DiskCacheIO::Open(const std::string &url, AVDictionary *options,
+                      const AVIOInterruptCB &interruptCb) {
+    AVDictionary *opts = nullptr;
+    av_dict_copy(&opts, options, 0);
+    int ret = avio_open2(&mInnerCtx, url.c_str(), AVIO_FLAG_READ, &interruptCb, &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        NEXT_LOGE(TAG, "avio_open2 error, ret=%d\n", ret);
+        return ret;
+    }
+    mFileSize = avio_size(mInnerCtx);
+    if (mCache && mInnerCtx->seekable) {
+        mEntry = mCache->Acquire(url, mFileSize);
+    }
+    if (mEntry) {
+        mBlock.resize(DISK_CACHE_BLOCK_SIZE);
+    }
+
+    auto *buffer = static_cast<uint8_t *>(av_malloc(DISK_CACHE_AVIO_SIZE));
+    mAvioCtx = buffer ? avio_alloc_context(buffer, DISK_CACHE_AVIO_SIZE, 0, this,
+                                           ReadPacket, nullptr, SeekPacket) : nullptr;
+    if (!mAvioCtx) {
+        av_free(buffer);
+        Close();
+        return AVERROR(ENOMEM);
+    }
+    mAvioCtx->seekable = mInnerCtx->seekable;
+    NEXT_LOGI(TAG, "open, size=%lld, cached=%lld\n", (long long) mFileSize,
+              mEntry ? (long long) mEntry->cached : -1LL);
+    return 0;
+}
+
+AVIOContext *DiskCacheIO::GetContext() {
+    return mAvioCtx;
+}
+
+void DiskCacheIO::Close() {
+    if (mEntry) {
+        DiskCacheStat stat = mCache->GetStat();
+        NEXT_LOGI(TAG, "close, hit=%lld miss=%lld total=%lld\n", (long long) stat.hit_bytes,
+                  (long long) stat.miss_bytes, (long long) stat.total_bytes);
+        mCache->Release(mEntry);
+        mEntry.reset();
+    }
+    if (mAvioCtx) {
+        av_freep(&mAvioCtx->buffer);
+        avio_context_free(&mAvioCtx);
+    }
+    avio_closep(&mInnerCtx);
+}
+
+int DiskCacheIO::ReadPacket(void *opaque, uint8_t *buf, int size) {
+    return static_cast<DiskCacheIO *>(opaque)->Read(buf, size);
+}
+
+int64_t DiskCacheIO::SeekPacket(void *opaque, int64_t offset, int whence) {
+    return static_cast<DiskCacheIO *>(opaque)->Seek(offset, whence);
+}
+
+int DiskCacheIO::Read(uint8_t *buf, int size) {
+    if (!mEntry) {
+        int ret = avio_read_partial(mInnerCtx, buf, size);
+        if (ret > 0) {
+            mPos += ret;
+        }
+        return ret == 0 ? AVERROR_EOF : ret;
+    }
+    if (mPos >= mFileSize) {
+        return AVERROR_EOF;
+    }
+
+    int64_t index = mPos / DISK_CACHE_BLOCK_SIZE;
+    auto offset = static_cast<int>(mPos - index * DISK_CACHE_BLOCK_SIZE);
+    // a short block is fetched again when read past its end
+    if (index != mBlockIndex || offset >= mBlockSize) {
+        int ret = LoadBlock(index);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    if (offset >= mBlockSize) {
+        return AVERROR_EOF;
+    }
+    int len = std::min(size, mBlockSize - offset);
+    memcpy(buf, mBlock.data() + offset, len);
+    mPos += len;
+    return len;
+}
+
+int64_t DiskCacheIO::Seek(int64_t offset, int whence) {
+    if (whence & AVSEEK_SIZE) {
+        return mFileSize >= 0 ? mFileSize : AVERROR(ENOSYS);
+    }
+    if (!mEntry) {
+        int64_t ret = avio_seek(mInnerCtx, offset, whence & ~AVSEEK_FORCE);
+        if (ret >= 0) {
+            mPos = ret;
+        }
+        return ret;
+    }
+
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = mPos + offset;
+            break;
+        case SEEK_END:
+            target = mFileSize + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+    // the protocol seeks lazily when a missing block is fetched
+    mPos = target;
+    return target;
+}
+
+int DiskCacheIO::LoadBlock(int64_t index) {
+    int size = DiskCache::BlockSize(*mEntry, index);
+    if (size <= 0) {
+        return AVERROR_EOF;
+    }
+    if (mCache->ReadBlock(mEntry, index, mBlock.data()) == size) {
+        mBlockIndex = index;
+        mBlockSize  = size;
+        return 0;
+    }
+    return FetchBlock(index, size);
+}
+
+int DiskCacheIO::FetchBlock(int64_t index, int size) {
+    mBlockIndex = -1;
+    int64_t start = index * DISK_CACHE_BLOCK_SIZE;
+    if (mInnerPos != start) {
+        int64_t ret = avio_seek(mInnerCtx, start, SEEK_SET);
+        if (ret < 0) {
+            NEXT_LOGE(TAG, "seek to %lld error, ret=%lld\n", (long long) start, (long long) ret);
+            return static_cast<int>(ret);
+        }
+        mInnerPos = start;
+    }
+
+    int filled = 0;
+    while (filled < size) {
+        int ret = avio_read(mInnerCtx, mBlock.data() + filled, size - filled);
+        if (ret <= 0) {
+            if (filled == 0) {
+                return ret == 0 ? AVERROR_EOF : ret;
+            }
+            break;
+        }
+        filled += ret;
+    }
+    mInnerPos += filled;
+
+    // a short block is served but not cached
+    if (filled == size) {
+        mCache->WriteBlock(mEntry, index, mBlock.data(), size);
+    }
+    mBlockIndex = index;
+    mBlockSize  = filled;
+    return 0;
+}
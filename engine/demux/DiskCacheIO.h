@@ -0,0 +1,69 @@
+#ifndef DISK_CACHE_IO_H
+#define DISK_CACHE_IO_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DiskCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavformat/avio.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define DISK_CACHE_AVIO_SIZE (32 * 1024)
+
+/**
+ * AVIOContext that serves reads from DiskCache in whole blocks and
+ * fetches missing blocks from the real protocol. Sources of unknown
+ * size (live) pass through uncached.
+ */
+class DiskCacheIO {
+public:
+    explicit DiskCacheIO(std::shared_ptr<DiskCache> cache);
+
+    ~DiskCacheIO();
+
+    int Open(const std::string &url, AVDictionary *options, const AVIOInterruptCB &interruptCb);
+
+    // owned by DiskCacheIO
+    AVIOContext *GetContext();
+
+    void Close();
+
+private:
+    static int ReadPacket(void *opaque, uint8_t *buf, int size);
+
+    static int64_t SeekPacket(void *opaque, int64_t offset, int whence);
+
+    int Read(uint8_t *buf, int size);
+
+    int64_t Seek(int64_t offset, int whence);
+
+    // load mBlock with the block at index, from disk or from the protocol
+    int LoadBlock(int64_t index);
+
+    int FetchBlock(int64_t index, int size);
+
+private:
+    std::shared_ptr<DiskCache> mCache;
+    std::shared_ptr<DiskCacheEntry> mEntry;
+
+    AVIOContext *mInnerCtx = nullptr;
+    AVIOContext *mAvioCtx  = nullptr;
+
+    std::vector<uint8_t> mBlock;
+    int64_t mBlockIndex = -1;
+    int mBlockSize      = 0;
+
+    int64_t mFileSize = -1;
+    int64_t mPos      = 0; // position of the demuxer
+    int64_t mInnerPos = 0; // position of the protocol
+};
+
+#endif //DISK_CACHE_IO_H
@@ -8,10 +8,13 @@
 #define EXTRACTOR_INTERFACE_H
 
 #include <algorithm>
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
 
 #include "NextDefine.h"
+#include "NextErrorCode.h"
 #include "NextStructDefine.h"
 
 #ifdef __cplusplus
@@ -26,8 +29,35 @@ extern "C" {
 struct FFmpegOption {
     AVDictionary *format_opts;
     AVDictionary *codec_opts;
+    bool read_ahead = false; // prefetch with a background thread
+    bool mmap_io    = false; // map local files instead of read(), for files not written while played
+    // > 0: play VOD hls through AdaptiveIO, downloading this many segments in parallel
+    int adaptive_prefetch = 0;
+    // deadlines of the phases of Open in us, 0: none
+    int64_t connect_timeout_us = 0; // dns and connect, http only
+    int64_t open_timeout_us    = 0; // avformat_open_input
+    int64_t probe_timeout_us   = 0; // avformat_find_stream_info
 };
 
+// one slot of ReadPackets, pkt is allocated by the caller (e.g. from a packet pool)
+struct ExtractorPacket {
+    AVPacket *pkt   = nullptr;
+    int stream_type = -1; // AVMediaType
+    int serial      = 0;
+};
+
+// byte counters of the demuxer, skipped = read but never returned as a packet
+// (unselected tracks, dropped packets and container overhead)
+struct DemuxStatistic {
+    int64_t read_bytes      = 0;
+    int64_t consumed_bytes  = 0;
+    int64_t skipped_bytes   = 0;
+    int64_t dropped_packets = 0;
+};
+
+// result of an asynchronous open, called on the opening thread
+using OpenCallback = std::function<void(int ret)>;
+
 class ExtractorInterface {
 public:
     virtual ~ExtractorInterface() = default;
@@ -35,8 +65,45 @@ public:
     virtual int Open(const std::string &url, FFmpegOption &opt,
                      std::shared_ptr<MetaData> &metadata) = 0;
 
+    // Open without blocking the caller, metadata is filled when the future is ready
+    virtual std::future<int> OpenAsync(const std::string &url, FFmpegOption &opt,
+                                       std::shared_ptr<MetaData> &metadata,
+                                       OpenCallback callback = nullptr) {
+        std::promise<int> promise;
+        int ret = Open(url, opt, metadata);
+        if (callback) {
+            callback(ret);
+        }
+        promise.set_value(ret);
+        return promise.get_future();
+    }
+
+    // an open in progress returns ERROR_PLAYER_ABORT
+    virtual void CancelOpen() {
+        SetInterrupt();
+    }
+
     virtual int ReadPacket(AVPacket *pkt) = 0;
 
+    // read up to count packets or maxBytes (<= 0: no limit), each tagged with its
+    // stream type and serial; returns the number read, or the error if none was read
+    virtual int ReadPackets(ExtractorPacket *packets, int count, int64_t maxBytes, int serial) {
+        int read = 0;
+        int64_t bytes = 0;
+        while (read < count && (maxBytes <= 0 || bytes < maxBytes)) {
+            ExtractorPacket &slot = packets[read];
+            int ret = ReadPacket(slot.pkt);
+            if (ret < 0) {
+                return read > 0 ? read : ret;
+            }
+            slot.stream_type = GetStreamType(slot.pkt->stream_index);
+            slot.serial = serial;
+            bytes += slot.pkt->size;
+            read++;
+        }
+        return read;
+    }
+
     virtual int Seek(int64_t timestamp, int64_t rel = 0, int seekFlags = 0) = 0;
 
     virtual int GetError() = 0;
@@ -45,6 +112,17 @@ public:
 
     virtual int GetStreamType(int streamIndex) = 0;
 
+    virtual void GetCacheStatistic(IOCacheStatistic &stat) {}
+
+    // enable or disable reading a stream, unselected streams are not demuxed
+    virtual int SelectTrack(int streamIndex, bool select) {
+        return ERROR_PLAYER_UNSUPPORTED;
+    }
+
+    virtual void GetDemuxStatistic(DemuxStatistic &stat) {}
+
+    virtual void GetAdaptiveStatistic(AdaptiveStatistic &stat) {}
+
     virtual void Close() = 0;
 };
 
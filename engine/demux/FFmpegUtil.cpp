@@ -59,7 +59,7 @@ double GetRotation(AVStream *st) {
 
 AVDictionary **FindStreamInfoOpts(AVFormatContext *s,
                                   AVDictionary *codec_opts) {
-    int i;
+    unsigned int i;
     AVDictionary **opts;
 
     if (!s->nb_streams)
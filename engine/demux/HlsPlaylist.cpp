@@ -0,0 +1,224 @@
+/**
+ * Note: parser of hls playlists
+ * Date: 2026/10/18
+ */
+
+#include "HlsPlaylist.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "NextLog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/error.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define TAG "HlsPlaylist"
+
+static bool StartWith(const std::string &line, const char *prefix, std::string *rest = nullptr) {
+    size_t len = strlen(prefix);
+    if (line.compare(0, len, prefix) != 0) {
+        return false;
+    }
+    if (rest) {
+        *rest = line.substr(len);
+    }
+    return true;
+}
+
+static std::vector<std::string> SplitLines(const std::string &text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        size_t end = line.find_last_not_of(" \t\r");
+        line.erase(end == std::string::npos ? 0 : end + 1);
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin != std::string::npos && !line.empty()) {
+            lines.push_back(line.substr(begin));
+        }
+    }
+    return lines;
+}
+
+bool HlsPlaylist::IsPlaylist(const std::string &text) {
+    size_t begin = text.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+    return text.compare(begin, 7, "#EXTM3U") == 0;
+}
+
+bool HlsPlaylist::IsMaster(const std::string &text) {
+    return text.find("#EXT-X-STREAM-INF:") != std::string::npos;
+}
+
+int HlsPlaylist::ParseMaster(const std::string &text, const std::string &baseUrl,
+                             std::vector<HlsVariant> &variants) {
+    std::vector<std::string> lines = SplitLines(text);
+    std::string attrs;
+    bool streamInf = false;
+    for (auto &line : lines) {
+        std::string rest;
+        if (StartWith(line, "#EXT-X-STREAM-INF:", &rest)) {
+            attrs = rest;
+            streamInf = true;
+        } else if (StartWith(line, "#EXT-X-MEDIA:", &rest)) {
+            // the demuxer reads a single byte stream, audio can't come from another playlist
+            if (GetAttribute(rest, "TYPE") == "AUDIO" && !GetAttribute(rest, "URI").empty()) {
+                NEXT_LOGI(TAG, "alternate audio rendition unsupported\n");
+                return AVERROR_PATCHWELCOME;
+            }
+        } else if (line[0] != '#' && streamInf) {
+            HlsVariant variant;
+            variant.url = ResolveUrl(baseUrl, line);
+            variant.bandwidth = strtoll(GetAttribute(attrs, "BANDWIDTH").c_str(), nullptr, 10);
+            std::string resolution = GetAttribute(attrs, "RESOLUTION");
+            size_t x = resolution.find('x');
+            if (x != std::string::npos) {
+                variant.width  = atoi(resolution.c_str());
+                variant.height = atoi(resolution.c_str() + x + 1);
+            }
+            variant.codecs = GetAttribute(attrs, "CODECS");
+            variant.order = static_cast<int>(variants.size());
+            variants.push_back(variant);
+            streamInf = false;
+        }
+    }
+    if (variants.empty()) {
+        return AVERROR_INVALIDDATA;
+    }
+    std::stable_sort(variants.begin(), variants.end(),
+                     [](const HlsVariant &a, const HlsVariant &b) {
+                         return a.bandwidth < b.bandwidth;
+                     });
+    return 0;
+}
+
+int HlsPlaylist::ParseMedia(const std::string &text, const std::string &baseUrl,
+                            std::vector<HlsSegment> &segments) {
+    std::vector<std::string> lines = SplitLines(text);
+    bool endList = false;
+    int64_t duration = -1;
+    int64_t start = 0;
+    for (auto &line : lines) {
+        std::string rest;
+        if (StartWith(line, "#EXTINF:", &rest)) {
+            duration = static_cast<int64_t>(strtod(rest.c_str(), nullptr) * 1000000);
+        } else if (StartWith(line, "#EXT-X-ENDLIST")) {
+            endList = true;
+        } else if (StartWith(line, "#EXT-X-KEY:", &rest)) {
+            if (GetAttribute(rest, "METHOD") != "NONE") {
+                NEXT_LOGI(TAG, "encrypted playlist unsupported\n");
+                return AVERROR_PATCHWELCOME;
+            }
+        } else if (StartWith(line, "#EXT-X-MAP:") || StartWith(line, "#EXT-X-BYTERANGE:")) {
+            NEXT_LOGI(TAG, "unsupported tag: %s\n", line.c_str());
+            return AVERROR_PATCHWELCOME;
+        } else if (line[0] != '#' && duration >= 0) {
+            HlsSegment segment;
+            segment.url         = ResolveUrl(baseUrl, line);
+            segment.start_us    = start;
+            segment.duration_us = duration;
+            segments.push_back(segment);
+            start += duration;
+            duration = -1;
+        }
+    }
+    // live playlists need reloading, leave them to the hls demuxer
+    if (!endList) {
+        NEXT_LOGI(TAG, "live playlist unsupported\n");
+        return AVERROR_PATCHWELCOME;
+    }
+    return segments.empty() ? AVERROR_INVALIDDATA : 0;
+}
+
+std::string HlsPlaylist::ResolveUrl(const std::string &baseUrl, const std::string &ref) {
+    if (ref.find("://") != std::string::npos) {
+        return ref;
+    }
+    size_t scheme = baseUrl.find("://");
+    if (ref.compare(0, 2, "//") == 0) {
+        return scheme == std::string::npos ? ref : baseUrl.substr(0, scheme + 1) + ref;
+    }
+    std::string base = baseUrl.substr(0, baseUrl.find_first_of("?#"));
+    if (!ref.empty() && ref[0] == '/') {
+        size_t host = scheme == std::string::npos ? std::string::npos : base.find('/', scheme + 3);
+        return (host == std::string::npos ? base : base.substr(0, host)) + ref;
+    }
+    size_t dir = base.rfind('/');
+    return (dir == std::string::npos ? "" : base.substr(0, dir + 1)) + ref;
+}
+
+bool HlsPlaylist::IsHlsUrl(const std::string &url) {
+    std::string path = url.substr(0, url.find_first_of("?#"));
+    if (path.size() < 5) {
+        return false;
+    }
+    std::string ext = path.substr(path.size() - 5);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".m3u8";
+}
+
+static std::vector<std::string> CodecFamilies(const std::string &codecs) {
+    std::vector<std::string> families;
+    std::istringstream stream(codecs);
+    std::string codec;
+    while (std::getline(stream, codec, ',')) {
+        size_t begin = codec.find_first_not_of(" \t");
+        if (begin == std::string::npos) {
+            continue;
+        }
+        std::string family = codec.substr(begin, codec.find('.', begin) - begin);
+        family.erase(family.find_last_not_of(" \t") + 1);
+        std::transform(family.begin(), family.end(), family.begin(), ::tolower);
+        // same bitstream, parameter sets in band or not
+        if (family == "avc3") {
+            family = "avc1";
+        } else if (family == "hev1") {
+            family = "hvc1";
+        }
+        families.push_back(family);
+    }
+    std::sort(families.begin(), families.end());
+    return families;
+}
+
+bool HlsPlaylist::SameCodecs(const std::string &a, const std::string &b) {
+    return CodecFamilies(a) == CodecFamilies(b);
+}
+
+std::string HlsPlaylist::GetAttribute(const std::string &attrs, const std::string &key) {
+    size_t pos = 0;
+    while (pos < attrs.size()) {
+        size_t eq = attrs.find('=', pos);
+        if (eq == std::string::npos) {
+            break;
+        }
+        std::string name = attrs.substr(pos, eq - pos);
+        std::string value;
+        size_t end;
+        if (eq + 1 < attrs.size() && attrs[eq + 1] == '"') {
+            size_t quote = attrs.find('"', eq + 2);
+            quote = quote == std::string::npos ? attrs.size() : quote;
+            value = attrs.substr(eq + 2, quote - eq - 2);
+            end = attrs.find(',', quote);
+        } else {
+            end = attrs.find(',', eq);
+            value = attrs.substr(eq + 1, (end == std::string::npos ? attrs.size() : end) - eq - 1);
+        }
+        if (name == key) {
+            return value;
+        }
+        if (end == std::string::npos) {
+            break;
+        }
+        pos = end + 1;
+    }
+    return "";
+}
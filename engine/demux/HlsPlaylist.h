@@ -0,0 +1,56 @@
+#ifndef HLS_PLAYLIST_H
+#define HLS_PLAYLIST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct HlsSegment {
+    std::string url;
+    int64_t start_us    = 0;
+    int64_t duration_us = 0;
+};
+
+struct HlsVariant {
+    std::string url;
+    int64_t bandwidth = 0; // bps, 0 if the playlist isn't a master playlist
+    int width  = 0;
+    int height = 0;
+    int order  = 0; // position in the master playlist, the first one is the default
+    std::string codecs; // CODECS attribute, empty if not declared
+};
+
+/**
+ * Parser of the subset of HLS that AdaptiveIO plays: VOD media playlists
+ * of plain MPEG-TS segments. Anything else is reported as unsupported so
+ * that the caller falls back to the hls demuxer of FFmpeg.
+ */
+class HlsPlaylist {
+public:
+    static bool IsPlaylist(const std::string &text);
+
+    static bool IsMaster(const std::string &text);
+
+    // variants sorted by bandwidth, AVERROR_PATCHWELCOME for alternate audio
+    static int ParseMaster(const std::string &text, const std::string &baseUrl,
+                           std::vector<HlsVariant> &variants);
+
+    // AVERROR_PATCHWELCOME for live, encrypted, fMP4 or byte range playlists
+    static int ParseMedia(const std::string &text, const std::string &baseUrl,
+                          std::vector<HlsSegment> &segments);
+
+    static std::string ResolveUrl(const std::string &baseUrl, const std::string &ref);
+
+    // true if both CODECS lists name the same codecs, profiles and levels aside,
+    // so that segments of the two variants can follow each other in one stream
+    static bool SameCodecs(const std::string &a, const std::string &b);
+
+    // true if the path of url ends with .m3u8
+    static bool IsHlsUrl(const std::string &url);
+
+private:
+    // value of key in an attribute list, quotes removed
+    static std::string GetAttribute(const std::string &attrs, const std::string &key);
+};
+
+#endif //HLS_PLAYLIST_H
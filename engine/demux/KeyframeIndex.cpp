@@ -0,0 +1,79 @@
+/**
+ * Note: index of keyframe position
+ * Date: 2026/10/18
+ */
+
+#include "KeyframeIndex.h"
+
+#include <algorithm>
+
+static bool ComparePts(const KeyframeEntry &entry, int64_t pts) {
+    return entry.pts < pts;
+}
+
+void KeyframeIndex::Reset(int streamIndex) {
+    mStreamIndex = streamIndex;
+    bDirty = false;
+    mEntries.clear();
+}
+
+int KeyframeIndex::StreamIndex() const {
+    return mStreamIndex;
+}
+
+bool KeyframeIndex::Add(int64_t pts, int64_t pos) {
+    if (pos < 0 || mEntries.size() >= KEYFRAME_INDEX_MAX) {
+        return false;
+    }
+    KeyframeEntry entry;
+    entry.pts = pts;
+    entry.pos = pos;
+    // sequential playback appends, after a seek entries go in the middle
+    if (mEntries.empty() || pts > mEntries.back().pts) {
+        mEntries.push_back(entry);
+    } else {
+        auto it = std::lower_bound(mEntries.begin(), mEntries.end(), pts, ComparePts);
+        if (it != mEntries.end() && it->pts == pts) {
+            return false;
+        }
+        mEntries.insert(it, entry);
+    }
+    bDirty = true;
+    return true;
+}
+
+bool KeyframeIndex::Find(int64_t target, KeyframeEntry &entry) const {
+    auto it = std::upper_bound(mEntries.begin(), mEntries.end(), target,
+                               [](int64_t pts, const KeyframeEntry &e) {
+                                   return pts < e.pts;
+                               });
+    // need a keyframe on both sides, otherwise a closer one may be unknown
+    if (it == mEntries.begin() || it == mEntries.end()) {
+        return false;
+    }
+    const KeyframeEntry &prev = *(it - 1);
+    if (it->pts - prev.pts > KEYFRAME_MAX_INTERVAL) {
+        return false;
+    }
+    entry = prev;
+    return true;
+}
+
+void KeyframeIndex::Load(const std::vector<KeyframeEntry> &entries) {
+    for (auto &entry : entries) {
+        Add(entry.pts, entry.pos);
+    }
+    bDirty = false;
+}
+
+const std::vector<KeyframeEntry> &KeyframeIndex::Entries() const {
+    return mEntries;
+}
+
+bool KeyframeIndex::IsDirty() const {
+    return bDirty;
+}
+
+void KeyframeIndex::ClearDirty() {
+    bDirty = false;
+}
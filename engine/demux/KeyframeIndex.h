@@ -0,0 +1,46 @@
+#ifndef KEYFRAME_INDEX_H
+#define KEYFRAME_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#define KEYFRAME_INDEX_MAX 65536
+// a larger gap between two entries means part of the file wasn't indexed
+#define KEYFRAME_MAX_INTERVAL (10 * 1000 * 1000)
+
+struct KeyframeEntry {
+    int64_t pts = 0; // AV_TIME_BASE
+    int64_t pos = 0; // byte offset of the packet
+};
+
+/**
+ * Keyframe positions of one stream, built as packets are read, so that
+ * formats without a seek index can seek by byte offset.
+ */
+class KeyframeIndex {
+public:
+    void Reset(int streamIndex);
+
+    int StreamIndex() const;
+
+    // keeps entries sorted by pts, returns false for a known or unusable entry
+    bool Add(int64_t pts, int64_t pos);
+
+    // nearest keyframe at or before target, only inside an indexed range
+    bool Find(int64_t target, KeyframeEntry &entry) const;
+
+    void Load(const std::vector<KeyframeEntry> &entries);
+
+    const std::vector<KeyframeEntry> &Entries() const;
+
+    bool IsDirty() const;
+
+    void ClearDirty();
+
+private:
+    int mStreamIndex = -1;
+    bool bDirty = false;
+    std::vector<KeyframeEntry> mEntries;
+};
+
+#endif //KEYFRAME_INDEX_H
@@ -0,0 +1,204 @@
+/**
+ * Note: avio layer over a memory mapped local file
+ * Date: 2026/10/18
+ */
+
+#include "MmapIO.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "NextLog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/avstring.h"
+#include "libavutil/mem.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define TAG "MmapIO"
+
+MmapIO::~MmapIO() {
+    Close();
+}
+
+int MmapIO::Open(const std::string &url) {
+    std::string path = LocalPath(url);
+    if (path.empty()) {
+        return AVERROR(EINVAL);
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return AVERROR(errno);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return AVERROR(EINVAL);
+    }
+    void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        NEXT_LOGW(TAG, "mmap error, errno=%d, size=%lld\n", errno, (long long) st.st_size);
+        close(fd);
+        return AVERROR(ENOMEM);
+    }
+    // kept open to follow the size of files still being written
+    mFd       = fd;
+    mData     = static_cast<uint8_t *>(data);
+    mMapSize  = static_cast<int64_t>(st.st_size);
+    mFileSize = mMapSize;
+    mPos      = 0;
+    madvise(mData, static_cast<size_t>(mMapSize), MADV_SEQUENTIAL);
+    Advise(0);
+
+    auto *buffer = static_cast<uint8_t *>(av_malloc(MMAP_AVIO_SIZE));
+    mAvioCtx = buffer ? avio_alloc_context(buffer, MMAP_AVIO_SIZE, 0, this,
+                                           ReadPacket, nullptr, SeekPacket) : nullptr;
+    if (!mAvioCtx) {
+        av_free(buffer);
+        Close();
+        return AVERROR(ENOMEM);
+    }
+    NEXT_LOGI(TAG, "open, size=%lld\n", (long long) mFileSize);
+    return 0;
+}
+
+AVIOContext *MmapIO::GetContext() {
+    return mAvioCtx;
+}
+
+void MmapIO::Close() {
+    if (mAvioCtx) {
+        av_freep(&mAvioCtx->buffer);
+        avio_context_free(&mAvioCtx);
+    }
+    if (mData) {
+        NEXT_LOGI(TAG, "close, advise=%lld, seek=%lld\n",
+                  (long long) mAdviseCount, (long long) mSeekCount);
+        munmap(mData, static_cast<size_t>(mMapSize));
+        mData = nullptr;
+    }
+    if (mFd >= 0) {
+        close(mFd);
+        mFd = -1;
+    }
+}
+
+std::string MmapIO::LocalPath(const std::string &url) {
+    const char *path = nullptr;
+    if (av_strstart(url.c_str(), "file:", &path)) {
+        return path;
+    }
+    if (url.find("://") != std::string::npos) {
+        return "";
+    }
+    return url;
+}
+
+int MmapIO::ReadPacket(void *opaque, uint8_t *buf, int size) {
+    return static_cast<MmapIO *>(opaque)->Read(buf, size);
+}
+
+int64_t MmapIO::SeekPacket(void *opaque, int64_t offset, int whence) {
+    return static_cast<MmapIO *>(opaque)->Seek(offset, whence);
+}
+
+int MmapIO::Read(uint8_t *buf, int size) {
+    // the file may have grown since it was mapped
+    if (mPos + size > mFileSize) {
+        UpdateSize();
+    }
+    if (mPos >= mFileSize) {
+        return AVERROR_EOF;
+    }
+    int len = static_cast<int>(std::min((int64_t) size, mFileSize - mPos));
+    // keep half a window advised ahead, so the fault never waits for the disk
+    if (mAdviseEnd < mFileSize && mPos + len > mAdviseEnd - MMAP_WILLNEED_SIZE / 2) {
+        Advise(mPos);
+    }
+    memcpy(buf, mData + mPos, len);
+    mPos += len;
+    return len;
+}
+
+int64_t MmapIO::Seek(int64_t offset, int whence) {
+    if (whence & AVSEEK_SIZE) {
+        UpdateSize();
+        return mFileSize;
+    }
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = mPos + offset;
+            break;
+        case SEEK_END:
+            target = mFileSize + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+    // skips inside the advised window need no new hint
+    if (target < mAdviseStart || target >= mAdviseEnd) {
+        mSeekCount++;
+        Advise(target);
+    }
+    mPos = target;
+    return target;
+}
+
+void MmapIO::Advise(int64_t pos) {
+    static const int64_t pageSize = sysconf(_SC_PAGESIZE);
+    // once per window, a truncated file is caught before its pages are touched
+    UpdateSize();
+    int64_t start = pos - pos % pageSize;
+    int64_t end = std::min(pos + MMAP_WILLNEED_SIZE, mFileSize);
+    if (end <= start) {
+        return;
+    }
+    madvise(mData + start, static_cast<size_t>(end - start), MADV_WILLNEED);
+    mAdviseStart = start;
+    mAdviseEnd   = end;
+    mAdviseCount++;
+}
+
+void MmapIO::UpdateSize() {
+    struct stat st {};
+    if (mFd < 0 || fstat(mFd, &st) != 0) {
+        return;
+    }
+    auto size = static_cast<int64_t>(st.st_size);
+    if (size < mFileSize) {
+        // pages past the end raise SIGBUS, stop reading there
+        NEXT_LOGW(TAG, "truncated, size %lld -> %lld\n", (long long) mFileSize, (long long) size);
+        mFileSize  = size;
+        mAdviseEnd = std::min(mAdviseEnd, size);
+        return;
+    }
+    if (size <= mMapSize) {
+        mFileSize = size;
+        return;
+    }
+    void *data = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, mFd, 0);
+    if (data == MAP_FAILED) {
+        return;
+    }
+    munmap(mData, static_cast<size_t>(mMapSize));
+    mData     = static_cast<uint8_t *>(data);
+    mMapSize  = size;
+    mFileSize = size;
+    madvise(mData, static_cast<size_t>(mMapSize), MADV_SEQUENTIAL);
+}
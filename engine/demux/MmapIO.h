@@ -0,0 +1,74 @@
+#ifndef MMAP_IO_H
+#define MMAP_IO_H
+
+#include <cstdint>
+#include <string>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavformat/avio.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define MMAP_AVIO_SIZE (64 * 1024)
+// pages asked for ahead of the read position
+#define MMAP_WILLNEED_SIZE (4 * 1024 * 1024)
+
+/**
+ * AVIOContext over a read-only mapping of a local file, reads are memcpy
+ * from the page cache instead of read() syscalls. The kernel is told the
+ * access pattern with madvise: sequential for playback, willneed for the
+ * range ahead of the read position and of each seek target. The size is
+ * checked with fstat at the mapped end and once per window: a growing file
+ * is mapped again, reads stop at the end of a truncated one. Touching a
+ * page truncated between two checks still raises SIGBUS, so the extractor
+ * only maps files when asked to.
+ */
+class MmapIO {
+public:
+    ~MmapIO();
+
+    // url is a path or "file:" url, fails for files that can't be mapped
+    int Open(const std::string &url);
+
+    // owned by MmapIO
+    AVIOContext *GetContext();
+
+    void Close();
+
+    // path of a local file, empty for other urls
+    static std::string LocalPath(const std::string &url);
+
+private:
+    static int ReadPacket(void *opaque, uint8_t *buf, int size);
+
+    static int64_t SeekPacket(void *opaque, int64_t offset, int whence);
+
+    int Read(uint8_t *buf, int size);
+
+    int64_t Seek(int64_t offset, int whence);
+
+    // WILLNEED from pos, at most once per window
+    void Advise(int64_t pos);
+
+    // follow the file size, maps the file again when it grew
+    void UpdateSize();
+
+private:
+    AVIOContext *mAvioCtx = nullptr;
+
+    int mFd = -1;
+    uint8_t *mData    = nullptr;
+    int64_t mMapSize  = 0;
+    int64_t mFileSize = 0;
+    int64_t mPos      = 0;
+    // range already advised
+    int64_t mAdviseStart = 0;
+    int64_t mAdviseEnd   = 0;
+    int64_t mAdviseCount = 0;
+    int64_t mSeekCount   = 0;
+};
+
+#endif //MMAP_IO_H
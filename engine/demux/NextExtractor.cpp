@@ -6,12 +6,19 @@
 
 #include "NextExtractor.h"
 
+#include "CommonUtil.h"
 #include "FFmpegUtil.h"
 #include "NextLog.h"
 #include "NextMessage.h"
 
 #define EXTRACTOR_TAG "RsExtractor"
 
+// probe limits when the probe cache hits but codec parameters are incomplete
+#define CACHE_HIT_PROBE_SIZE (64 * 1024)
+#define CACHE_HIT_ANALYZE_DURATION (AV_TIME_BASE / 5)
+// formats without a seek index, seeking them by time scans the file
+#define KEYFRAME_INDEX_FORMATS "mpegts,flv,h264,hevc,mpeg,mpegvideo"
+
 NextExtractor::NextExtractor(NotifyCallback &notifyCb)
         : mNotifyCb(notifyCb) {
 
@@ -21,6 +28,10 @@ NextExtractor::NextExtractor(NotifyCallback &notifyCb)
 }
 
 NextExtractor::~NextExtractor() {
+    if (mOpenThread.joinable()) {
+        CancelOpen();
+        mOpenThread.join();
+    }
     NEXT_LOGD(EXTRACTOR_TAG, "RsExtractor destructor\n");
 }
 
@@ -54,22 +65,59 @@ int NextExtractor::Open(const std::string &url, FFmpegOption &opt,
     int ret = 0;
     int streamCount = 0;
     if (!mFormatCtx || url.empty() || metadata == nullptr) {
-        RS_LOGE(EXTRACTOR_TAG, "extractor Open null, [%d, %d, %d]\n",
+        NEXT_LOGE(EXTRACTOR_TAG, "extractor Open null, [%d, %d, %d]\n",
                   !mFormatCtx, url.empty(), metadata == nullptr);
         return -1;
     }
 
-    ret = avformat_open_input(&mFormatCtx, url.c_str(), nullptr,
+    mOpenTimeUs = SteadyTimeUs();
+    bFirstPacket = true;
+    bProbeCacheHit = false;
+    int32_t connectMs = 0;
+    int32_t openMs = 0;
+    int32_t probeMs = 0;
+    BeginPhase(opt.connect_timeout_us);
+    ret = EndPhase(OpenIO(url, opt), ERROR_NET_CON_TIMEOUT, &connectMs);
+    if (ret < 0) {
+        NEXT_LOGE(EXTRACTOR_TAG, "open io error, ret=%d, cost=%dms\n", ret, connectMs);
+        return ret;
+    }
+    // segments of AdaptiveIO are mpegts, the url names the playlist
+    const AVInputFormat *format = mAdaptiveIO ? av_find_input_format("mpegts") : nullptr;
+    BeginPhase(opt.open_timeout_us);
+    ret = avformat_open_input(&mFormatCtx, url.c_str(), format,
                               opt.format_opts ? &opt.format_opts : nullptr);
+    ret = EndPhase(ret, ERROR_NET_READ_TIMEOUT, &openMs);
     if (ret < 0) {
-        NEXT_LOGE(EXTRACTOR_TAG, "avformat_open_input error, ret=%d\n", ret);
+        NEXT_LOGE(EXTRACTOR_TAG, "avformat_open_input error, ret=%d, cost=%dms\n", ret, openMs);
         return ret;
     }
-    NotifyListener(MSG_OPEN_INPUT);
+    NotifyListener(MSG_OPEN_INPUT, connectMs + openMs, connectMs);
     av_format_inject_global_side_data(mFormatCtx);
     AVDictionary **opts = FindStreamInfoOpts(mFormatCtx, opt.codec_opts);
     streamCount = (int) mFormatCtx->nb_streams;
+
+    ProbeValidator validator;
+    ProbeCacheEntry cacheEntry;
+    if (mProbeCache) {
+        validator = GetValidator(url);
+        bProbeCacheHit = validator.size > 0 && mProbeCache->Lookup(url, validator, cacheEntry);
+    }
     do {
+        if (bProbeCacheHit) {
+            bool needProbe = true;
+            // no mtime: a network source, whose size alone doesn't prove the version
+            if (ApplyProbeCache(cacheEntry, validator.mtime == 0, &needProbe)) {
+                if (!needProbe) {
+                    break;
+                }
+                mFormatCtx->probesize = CACHE_HIT_PROBE_SIZE;
+                mFormatCtx->max_analyze_duration = CACHE_HIT_ANALYZE_DURATION;
+            } else {
+                bProbeCacheHit = false;
+                mProbeCache->Remove(url);
+            }
+        }
         if (av_stristart(url.c_str(), "data:", nullptr) && streamCount > 0) {
             int i = 0;
             for (i = 0; i < streamCount; i++) {
@@ -83,10 +131,14 @@ int NextExtractor::Open(const std::string &url, FFmpegOption &opt,
                 break;
             }
         }
+        BeginPhase(opt.probe_timeout_us);
         ret = avformat_find_stream_info(mFormatCtx, opts);
+        ret = EndPhase(ret, ERROR_NET_READ_TIMEOUT, &probeMs);
     } while (false);
 
-    NotifyListener(MSG_FIND_STREAM_INFO);
+    NEXT_LOGI(EXTRACTOR_TAG, "open phases: connect=%dms, open=%dms, probe=%dms\n",
+              connectMs, openMs, probeMs);
+    NotifyListener(MSG_FIND_STREAM_INFO, probeMs, bProbeCacheHit ? 1 : 0);
 
     for (int i = 0; i < streamCount; i++) {
         av_dict_free(&opts[i]);
@@ -99,10 +151,33 @@ int NextExtractor::Open(const std::string &url, FFmpegOption &opt,
         return ret;
     }
 
+    if (mAdaptiveIO && mFormatCtx->duration <= 0) {
+        mFormatCtx->duration = mAdaptiveIO->GetDuration();
+    }
+    if (mReadAhead) {
+        mReadAhead->SetCapacity(ReadAheadIO::CapacityOfBitrate(
+                bProbeCacheHit ? cacheEntry.bit_rate : mFormatCtx->bit_rate));
+    }
+    mUrl = url;
+    mValidator = validator;
+    mPendingError = 0;
+    mLastTimeUs = AV_NOPTS_VALUE;
+    mReadBytes = 0;
+    mConsumedBytes = 0;
+    mDroppedPackets = 0;
+    UpdateStreamState();
+    SetupKeyframeIndex(bProbeCacheHit ? &cacheEntry : nullptr);
+    if (bProbeCacheHit) {
+        NEXT_LOGI(EXTRACTOR_TAG, "probe cache hit, cost=%lldms\n",
+                  (long long) (SteadyTimeUs() - mOpenTimeUs) / 1000);
+        ProbeCache::ToMetaData(cacheEntry, *metadata);
+        return 0;
+    }
+
     metadata->duration   = mFormatCtx->duration;
     metadata->bit_rate   = mFormatCtx->bit_rate;
     metadata->start_time = mFormatCtx->start_time;
-    for (int i = 0; i < mFormatCtx->nb_streams; i++) {
+    for (unsigned int i = 0; i < mFormatCtx->nb_streams; i++) {
         TrackInfo info;
         AVStream *st = mFormatCtx->streams[i];
         info.rotation = GetRotationRound(st);
@@ -139,38 +214,128 @@ int NextExtractor::Open(const std::string &url, FFmpegOption &opt,
             info.color_primaries = st->codecpar->color_primaries;
             info.stream_type     = st->codecpar->codec_type;
             info.codec_profile   = st->codecpar->profile;
-            info.extra_data_size = st->codecpar->extradata_size;
-
-            if (st->codecpar->extradata_size > 0 && st->codecpar->extradata) {
-                info.extra_data = new uint8_t[st->codecpar->extradata_size + 1];
-                memcpy(info.extra_data, st->codecpar->extradata,
-                       st->codecpar->extradata_size);
-            }
+            // the only copy, the stream is gone once the extractor closes
+            info.extra_data = MakeExtraData(st->codecpar->extradata,
+                                            st->codecpar->extradata_size);
         }
 
         metadata->track_info.push_back(info);
     }
 
+    if (mProbeCache && validator.size > 0) {
+        mProbeCache->Store(url, validator, *metadata);
+    }
     return 0;
 }
 
 int NextExtractor::ReadPacket(AVPacket *pkt) {
     int ret = -1;
-    if (mFormatCtx) {
+    while (mFormatCtx) {
         ret = av_read_frame(mFormatCtx, pkt);
+        if (ret < 0 || AcceptPacket(pkt)) {
+            break;
+        }
+        av_packet_unref(pkt);
+        mDroppedPackets++;
+    }
+    if (mFormatCtx && mFormatCtx->pb) {
+        mReadBytes = mFormatCtx->pb->bytes_read;
+    }
+    if (ret >= 0) {
+        mConsumedBytes += pkt->size;
+    }
+    if (ret >= 0 && bIndexSeek && pkt->stream_index == mKeyIndex.StreamIndex()
+        && (pkt->flags & AV_PKT_FLAG_KEY) && pkt->pts != AV_NOPTS_VALUE) {
+        AVStream *st = mFormatCtx->streams[pkt->stream_index];
+        mKeyIndex.Add(av_rescale_q(pkt->pts, st->time_base, AV_TIME_BASE_Q), pkt->pos);
+    }
+    AdaptiveStatistic adaptive;
+    if (ret >= 0 && mAdaptiveIO && mAdaptiveIO->TakeSwitch(adaptive)) {
+        NotifyListener(MSG_VARIANT_SWITCHED, static_cast<int32_t>(adaptive.variant_bitrate / 1000),
+                       adaptive.switch_reason);
+        // the track info of the open is stale, the decoder follows the new sps in band
+        if (adaptive.width > 0 && adaptive.height > 0
+            && (adaptive.width != mVariantWidth || adaptive.height != mVariantHeight)) {
+            mVariantWidth  = adaptive.width;
+            mVariantHeight = adaptive.height;
+            NotifyListener(MSG_VIDEO_SIZE_CHANGED, adaptive.width, adaptive.height);
+        }
+    }
+    if (ret >= 0 && bFirstPacket) {
+        bFirstPacket = false;
+        auto cost = static_cast<int32_t>((SteadyTimeUs() - mOpenTimeUs) / 1000);
+        NEXT_LOGI(EXTRACTOR_TAG, "open to first packet: %dms, cache hit=%d\n",
+                  cost, bProbeCacheHit);
+        NotifyListener(MSG_OPEN_FIRST_PACKET, cost, bProbeCacheHit ? 1 : 0);
     }
     return ret;
 }
 
+int NextExtractor::ReadPackets(ExtractorPacket *packets, int count, int64_t maxBytes, int serial) {
+    if (mPendingError < 0) {
+        int ret = mPendingError;
+        mPendingError = 0;
+        return ret;
+    }
+    int read = 0;
+    int64_t bytes = 0;
+    while (read < count && (maxBytes <= 0 || bytes < maxBytes)) {
+        ExtractorPacket &slot = packets[read];
+        int ret = ReadPacket(slot.pkt);
+        if (ret < 0) {
+            if (read == 0) {
+                return ret;
+            }
+            mPendingError = ret;
+            break;
+        }
+        slot.stream_type = mStreamTypes[slot.pkt->stream_index];
+        slot.serial = serial;
+        bytes += slot.pkt->size;
+        read++;
+    }
+    return read;
+}
+
 int NextExtractor::Seek(int64_t timestamp, int64_t rel, int seekFlags) {
+    int64_t position = timestamp;
     if (mFormatCtx->start_time != AV_NOPTS_VALUE) {
         timestamp += mFormatCtx->start_time;
     }
+    mPendingError = 0;
+    // every packet after a seek is new
+    std::fill(mLastDts.begin(), mLastDts.end(), AV_NOPTS_VALUE);
+    std::fill(mResyncDts.begin(), mResyncDts.end(), AV_NOPTS_VALUE);
+    mLastTimeUs = AV_NOPTS_VALUE;
+    // the stream can't seek by bytes, restart from the segment and resync the demuxer
+    if (mAdaptiveIO) {
+        int ret = mAdaptiveIO->SeekTime(position);
+        avformat_flush(mFormatCtx);
+        avio_flush(mFormatCtx->pb);
+        // left set by a read to the end, avio returns eof until cleared
+        mFormatCtx->pb->eof_reached = 0;
+        return ret;
+    }
     int64_t seek_min = rel > 0 ? timestamp - rel + 2 : INT64_MIN;
     int64_t seek_max = rel < 0 ? timestamp - rel - 2 : INT64_MAX;
-    int ret = avformat_seek_file(mFormatCtx, -1,
-                                 seek_min, timestamp, seek_max, seekFlags);
-    return ret;
+    return SeekTo(timestamp, seek_min, seek_max, seekFlags);
+}
+
+int NextExtractor::SeekTo(int64_t timestamp, int64_t seekMin, int64_t seekMax, int seekFlags) {
+    KeyframeEntry keyframe;
+    if (bIndexSeek && mKeyIndex.Find(timestamp, keyframe)) {
+        int64_t begin = SteadyTimeUs();
+        int ret = avformat_seek_file(mFormatCtx, -1, keyframe.pos, keyframe.pos,
+                                     keyframe.pos, AVSEEK_FLAG_BYTE);
+        if (ret >= 0) {
+            NEXT_LOGI(EXTRACTOR_TAG, "index seek to %lld, keyframe=%lld, cost=%lldus\n",
+                      (long long) timestamp, (long long) keyframe.pts,
+                      (long long) (SteadyTimeUs() - begin));
+            return ret;
+        }
+        NEXT_LOGW(EXTRACTOR_TAG, "index seek error, ret=%d\n", ret);
+    }
+    return avformat_seek_file(mFormatCtx, -1, seekMin, timestamp, seekMax, seekFlags);
 }
 
 int NextExtractor::GetError() {
@@ -183,7 +348,8 @@ int NextExtractor::GetError() {
 
 int NextExtractor::GetStreamType(int streamIndex) {
     int ret = -1;
-    if (mFormatCtx && mFormatCtx->streams && streamIndex < mFormatCtx->nb_streams) {
+    if (mFormatCtx && mFormatCtx->streams && streamIndex >= 0 &&
+        streamIndex < static_cast<int>(mFormatCtx->nb_streams)) {
         ret = static_cast<int>(mFormatCtx->streams[streamIndex]->codecpar->codec_type);
     }
     return ret;
@@ -192,20 +358,362 @@ int NextExtractor::GetStreamType(int streamIndex) {
 void NextExtractor::SetInterrupt() {
     NEXT_LOGD(EXTRACTOR_TAG, "extractor interrupt.\n");
     bAbort.store(true);
+    if (mReadAhead) {
+        mReadAhead->Abort();
+    }
+    if (mAdaptiveIO) {
+        mAdaptiveIO->Abort();
+    }
+}
+
+void NextExtractor::GetCacheStatistic(IOCacheStatistic &stat) {
+    if (mReadAhead) {
+        mReadAhead->GetStatistic(stat);
+    } else if (mAdaptiveIO) {
+        mAdaptiveIO->GetCacheStatistic(stat);
+    }
+}
+
+int NextExtractor::SelectTrack(int streamIndex, bool select) {
+    if (!mFormatCtx || !mFormatCtx->iformat) {
+        return ERROR_PARSE_NOT_INIT;
+    }
+    if (streamIndex < 0 || streamIndex >= static_cast<int>(mFormatCtx->nb_streams)) {
+        NEXT_LOGE(EXTRACTOR_TAG, "select invalid track: %d\n", streamIndex);
+        return ERROR_PARSE_STREAM_OPEN;
+    }
+    AVStream *st = mFormatCtx->streams[streamIndex];
+    AVDiscard discard = select ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    if (st->discard == discard) {
+        return 0;
+    }
+    st->discard = discard;
+    NEXT_LOGI(EXTRACTOR_TAG, "select track %d: %d\n", streamIndex, select);
+    // nothing returned yet, or the demuxer only has to stop
+    if (!select || mLastTimeUs == AV_NOPTS_VALUE) {
+        return 0;
+    }
+
+    // back to the keyframe before the last returned packet, the new track starts
+    // there while the others skip what they have returned already
+    UpdateStreamState();
+    int ret = SeekTo(mLastTimeUs, INT64_MIN, mLastTimeUs, 0);
+    if (ret < 0) {
+        NEXT_LOGE(EXTRACTOR_TAG, "switch track %d error, ret=%d\n", streamIndex, ret);
+        st->discard = AVDISCARD_ALL;
+        switch (st->codecpar->codec_type) {
+            case AVMEDIA_TYPE_VIDEO:
+                return ERROR_PARSE_SWITCH_VIDEO;
+            case AVMEDIA_TYPE_AUDIO:
+                return ERROR_PARSE_SWITCH_AUDIO;
+            default:
+                return ERROR_PARSE_SWITCH_SUB;
+        }
+    }
+    for (size_t i = 0; i < mResyncDts.size(); i++) {
+        mResyncDts[i] = static_cast<int>(i) == streamIndex ? AV_NOPTS_VALUE : mLastDts[i];
+    }
+    mPendingError = 0;
+    return 0;
+}
+
+void NextExtractor::GetAdaptiveStatistic(AdaptiveStatistic &stat) {
+    if (mAdaptiveIO) {
+        mAdaptiveIO->GetStatistic(stat);
+    }
+}
+
+void NextExtractor::GetDemuxStatistic(DemuxStatistic &stat) {
+    stat.read_bytes      = mReadBytes;
+    stat.consumed_bytes  = mConsumedBytes;
+    stat.skipped_bytes   = std::max(stat.read_bytes - stat.consumed_bytes, (int64_t) 0);
+    stat.dropped_packets = mDroppedPackets;
 }
 
 void NextExtractor::Close() {
     NEXT_LOGD(EXTRACTOR_TAG, "close begin\n");
+    if (mOpenThread.joinable()) {
+        CancelOpen();
+        mOpenThread.join();
+    }
+    if (mProbeCache && mKeyIndex.IsDirty() && mValidator.size > 0) {
+        mProbeCache->StoreKeyframes(mUrl, mValidator, mKeyIndex);
+        mKeyIndex.ClearDirty();
+    }
     if (mFormatCtx) {
         avformat_close_input(&mFormatCtx);
         mFormatCtx = nullptr;
     }
+    // the custom pb isn't freed by avformat_close_input, read-ahead sits on the disk cache
+    mReadAhead.reset();
+    mDiskCacheIO.reset();
+    mMmapIO.reset();
+    mAdaptiveIO.reset();
+    avio_closep(&mProtocolCtx);
     NEXT_LOGD(EXTRACTOR_TAG, "close end\n");
 }
 
+void NextExtractor::SetDiskCache(std::shared_ptr<DiskCache> cache) {
+    mDiskCache = std::move(cache);
+}
+
+int NextExtractor::OpenIO(const std::string &url, FFmpegOption &opt) {
+    int ret;
+    AVIOContext *pb = nullptr;
+    if (opt.adaptive_prefetch > 0 && HlsPlaylist::IsHlsUrl(url)) {
+        mAdaptiveIO.reset(new AdaptiveIO());
+        ret = mAdaptiveIO->Open(url, opt.format_opts, mFormatCtx->interrupt_callback,
+                                opt.adaptive_prefetch);
+        if (ret >= 0) {
+            mFormatCtx->pb = mAdaptiveIO->GetContext();
+            AdaptiveStatistic adaptive;
+            mAdaptiveIO->GetStatistic(adaptive);
+            mVariantWidth  = adaptive.width;
+            mVariantHeight = adaptive.height;
+            return 0;
+        }
+        // live, encrypted or fMP4 playlists are left to the hls demuxer
+        NEXT_LOGI(EXTRACTOR_TAG, "adaptive io unavailable, ret=%d\n", ret);
+        mAdaptiveIO.reset();
+    }
+    bool http = av_strstart(url.c_str(), "http://", nullptr)
+                || av_strstart(url.c_str(), "https://", nullptr);
+    // only http sources have a size and byte ranges to cache blocks of,
+    // rtsp, rtmp, udp and the like go to the demuxer's own protocol
+    if (mDiskCache && http) {
+        mDiskCacheIO.reset(new DiskCacheIO(mDiskCache));
+        ret = mDiskCacheIO->Open(url, opt.format_opts, mFormatCtx->interrupt_callback);
+        if (ret < 0) {
+            NEXT_LOGW(EXTRACTOR_TAG, "disk cache io unavailable, ret=%d\n", ret);
+            mDiskCacheIO.reset();
+        } else {
+            pb = mDiskCacheIO->GetContext();
+        }
+    }
+    if (!pb && http) {
+        // open the protocol here, so dns and connect are a phase of their own
+        AVDictionary *opts = nullptr;
+        av_dict_copy(&opts, opt.format_opts, 0);
+        ret = avio_open2(&mProtocolCtx, url.c_str(), AVIO_FLAG_READ,
+                         &mFormatCtx->interrupt_callback, &opts);
+        av_dict_free(&opts);
+        if (ret < 0) {
+            NEXT_LOGE(EXTRACTOR_TAG, "avio_open2 error, ret=%d\n", ret);
+            return ret;
+        }
+        pb = mProtocolCtx;
+    } else if (!http && opt.mmap_io && !MmapIO::LocalPath(url).empty()) {
+        mMmapIO.reset(new MmapIO());
+        // e.g. pipes or data: urls, the file protocol handles them
+        if (mMmapIO->Open(url) < 0) {
+            mMmapIO.reset();
+        } else {
+            pb = mMmapIO->GetContext();
+        }
+    }
+    // a mapped file is already in memory, nothing to read ahead
+    if (opt.read_ahead && !mMmapIO) {
+        mReadAhead.reset(new ReadAheadIO());
+        if (pb) {
+            ret = mReadAhead->Open(pb);
+        } else {
+            ret = mReadAhead->Open(url, opt.format_opts, mFormatCtx->interrupt_callback);
+        }
+        if (ret < 0) {
+            mReadAhead.reset();
+            mDiskCacheIO.reset();
+            avio_closep(&mProtocolCtx);
+            return ret;
+        }
+        pb = mReadAhead->GetContext();
+    }
+    if (pb) {
+        mFormatCtx->pb = pb;
+    }
+    return 0;
+}
+
+void NextExtractor::SetProbeCache(std::shared_ptr<ProbeCache> cache) {
+    mProbeCache = std::move(cache);
+}
+
+void NextExtractor::UpdateStreamState() {
+    mStreamTypes.resize(mFormatCtx->nb_streams, AVMEDIA_TYPE_UNKNOWN);
+    mLastDts.resize(mFormatCtx->nb_streams, AV_NOPTS_VALUE);
+    mResyncDts.resize(mFormatCtx->nb_streams, AV_NOPTS_VALUE);
+    for (unsigned int i = 0; i < mFormatCtx->nb_streams; i++) {
+        AVCodecParameters *par = mFormatCtx->streams[i]->codecpar;
+        mStreamTypes[i] = par ? par->codec_type : AVMEDIA_TYPE_UNKNOWN;
+    }
+}
+
+bool NextExtractor::AcceptPacket(const AVPacket *pkt) {
+    int index = pkt->stream_index;
+    // streams may be added while reading (e.g. mpegts)
+    if (index >= static_cast<int>(mStreamTypes.size())) {
+        UpdateStreamState();
+    }
+    AVStream *st = mFormatCtx->streams[index];
+    // read before the track was unselected
+    if (st->discard == AVDISCARD_ALL) {
+        return false;
+    }
+    if (mResyncDts[index] != AV_NOPTS_VALUE) {
+        if (pkt->dts == AV_NOPTS_VALUE || pkt->dts <= mResyncDts[index]) {
+            return false;
+        }
+        mResyncDts[index] = AV_NOPTS_VALUE;
+    }
+    if (pkt->dts != AV_NOPTS_VALUE) {
+        mLastDts[index] = pkt->dts;
+        mLastTimeUs = av_rescale_q(pkt->dts, st->time_base, AV_TIME_BASE_Q);
+    }
+    return true;
+}
+
+void NextExtractor::SetupKeyframeIndex(const ProbeCacheEntry *entry) {
+    const AVInputFormat *format = mFormatCtx->iformat;
+    bIndexSeek = format && !mAdaptiveIO && av_match_name(format->name, KEYFRAME_INDEX_FORMATS)
+                 && !(format->flags & AVFMT_NO_BYTE_SEEK);
+    if (!bIndexSeek) {
+        return;
+    }
+    int index = av_find_best_stream(mFormatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (index < 0) {
+        index = av_find_best_stream(mFormatCtx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    }
+    if (index < 0) {
+        bIndexSeek = false;
+        return;
+    }
+    mKeyIndex.Reset(index);
+    if (entry && entry->keyframe_stream == index) {
+        mKeyIndex.Load(entry->keyframes);
+        NEXT_LOGI(EXTRACTOR_TAG, "load %zu keyframes\n", entry->keyframes.size());
+    }
+}
+
+ProbeValidator NextExtractor::GetValidator(const std::string &url) {
+    ProbeValidator validator = ProbeCache::LocalValidator(url);
+    // network source: the size reported by the protocol, unknown for live
+    if (validator.size <= 0 && mFormatCtx->pb) {
+        validator.size = avio_size(mFormatCtx->pb);
+    }
+    return validator;
+}
+
+bool NextExtractor::ApplyProbeCache(const ProbeCacheEntry &entry, bool verify,
+                                    bool *needProbe) {
+    if (entry.track_info.size() != mFormatCtx->nb_streams) {
+        return false;
+    }
+    *needProbe = false;
+    for (unsigned int i = 0; i < mFormatCtx->nb_streams; i++) {
+        AVCodecParameters *par = mFormatCtx->streams[i]->codecpar;
+        const TrackInfo &info = entry.track_info[i];
+        if (!par || (par->codec_id != AV_CODEC_ID_NONE && par->codec_id != info.codec_id)) {
+            return false;
+        }
+        if (verify && !MatchHeader(par, info)) {
+            return false;
+        }
+        if (par->codec_id == AV_CODEC_ID_NONE
+            || (par->codec_type == AVMEDIA_TYPE_VIDEO && par->width <= 0)
+            || (par->codec_type == AVMEDIA_TYPE_AUDIO && par->sample_rate <= 0)) {
+            *needProbe = true;
+        }
+    }
+    // find_stream_info is skipped, restore what it would have computed
+    if (!*needProbe) {
+        if (mFormatCtx->start_time == AV_NOPTS_VALUE) {
+            mFormatCtx->start_time = entry.start_time;
+        }
+        if (mFormatCtx->duration == AV_NOPTS_VALUE) {
+            mFormatCtx->duration = entry.duration;
+        }
+    }
+    return true;
+}
+
+bool NextExtractor::MatchHeader(const AVCodecParameters *par, const TrackInfo &info) {
+    // everything the header has must be what the cache has, a hit is never
+    // taken on an entry that can't be checked
+    if (par->codec_id == AV_CODEC_ID_NONE) {
+        return false;
+    }
+    size_t extraSize = info.extra_data ? info.extra_data->size() : 0;
+    if (static_cast<size_t>(std::max(par->extradata_size, 0)) != extraSize
+        || (extraSize > 0 && memcmp(par->extradata, info.extra_data->data(), extraSize) != 0)) {
+        return false;
+    }
+    if (par->codec_type == AVMEDIA_TYPE_VIDEO && par->width > 0
+        && (par->width != info.width || par->height != info.height)) {
+        return false;
+    }
+    if (par->codec_type == AVMEDIA_TYPE_AUDIO && par->sample_rate > 0
+        && par->sample_rate != info.sample_rate) {
+        return false;
+    }
+    return true;
+}
+
 int NextExtractor::InterruptCallback(void *opaque) {
-    return static_cast<NextExtractor *>(opaque)->bAbort.load(
-            std::memory_order_relaxed);
+    auto *extractor = static_cast<NextExtractor *>(opaque);
+    if (extractor->bAbort.load(std::memory_order_relaxed)) {
+        return 1;
+    }
+    int64_t deadline = extractor->mDeadlineUs.load(std::memory_order_relaxed);
+    return deadline > 0 && SteadyTimeUs() > deadline;
+}
+
+void NextExtractor::BeginPhase(int64_t timeoutUs) {
+    mPhaseStartUs = SteadyTimeUs();
+    mDeadlineUs = timeoutUs > 0 ? mPhaseStartUs + timeoutUs : 0;
+}
+
+int NextExtractor::EndPhase(int ret, int timeoutCode, int32_t *costMs) {
+    int64_t now = SteadyTimeUs();
+    int64_t deadline = mDeadlineUs.exchange(0);
+    *costMs = static_cast<int32_t>((now - mPhaseStartUs) / 1000);
+    if (ret >= 0) {
+        return ret;
+    }
+    if (bAbort) {
+        return ERROR_PLAYER_ABORT;
+    }
+    return deadline > 0 && now > deadline ? timeoutCode : ret;
+}
+
+std::future<int> NextExtractor::OpenAsync(const std::string &url, FFmpegOption &opt,
+                                          std::shared_ptr<MetaData> &metadata,
+                                          OpenCallback callback) {
+    if (mOpenThread.joinable()) {
+        mOpenThread.join();
+    }
+    // the caller may free its dictionaries once this returns
+    FFmpegOption option = opt;
+    option.format_opts = nullptr;
+    option.codec_opts  = nullptr;
+    av_dict_copy(&option.format_opts, opt.format_opts, 0);
+    av_dict_copy(&option.codec_opts, opt.codec_opts, 0);
+
+    std::shared_ptr<std::promise<int>> promise(new std::promise<int>());
+    std::future<int> future = promise->get_future();
+    std::shared_ptr<MetaData> result = metadata;
+    mOpenThread = std::thread([this, url, option, result, callback, promise]() mutable {
+        int ret = Open(url, option, result);
+        av_dict_free(&option.format_opts);
+        av_dict_free(&option.codec_opts);
+        if (callback) {
+            callback(ret);
+        }
+        promise->set_value(ret);
+    });
+    return future;
+}
+
+void NextExtractor::CancelOpen() {
+    SetInterrupt();
 }
 
 void NextExtractor::NotifyListener(int32_t what, int32_t arg1, int32_t arg2, void *obj, int len) {
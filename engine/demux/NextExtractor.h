@@ -1,7 +1,16 @@
 #ifndef NEXT_EXTRACTOR_H
 #define NEXT_EXTRACTOR_H
 
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include "AdaptiveIO.h"
+#include "DiskCacheIO.h"
 #include "ExtractorInterface.h"
+#include "MmapIO.h"
+#include "ProbeCache.h"
+#include "ReadAheadIO.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,8 +30,19 @@ public:
     int Open(const std::string &url, FFmpegOption &opt,
              std::shared_ptr<MetaData> &metadata) override;
 
+    // the callback and the future are completed on an internal thread, don't
+    // call other methods before that; Close() cancels an open in progress
+    std::future<int> OpenAsync(const std::string &url, FFmpegOption &opt,
+                               std::shared_ptr<MetaData> &metadata,
+                               OpenCallback callback = nullptr) override;
+
+    void CancelOpen() override;
+
     int ReadPacket(AVPacket *pkt) override;
 
+    // an error after the first packet is kept and returned by the next call
+    int ReadPackets(ExtractorPacket *packets, int count, int64_t maxBytes, int serial) override;
+
     int Seek(int64_t timestamp, int64_t rel, int seekFlags) override;
 
     int GetError() override;
@@ -31,11 +51,51 @@ public:
 
     void SetInterrupt() override;
 
+    void GetCacheStatistic(IOCacheStatistic &stat) override;
+
+    // call on the parser thread, selecting a track while reading re-seeks
+    // to the last returned packet so that the new track starts there
+    int SelectTrack(int streamIndex, bool select) override;
+
+    void GetDemuxStatistic(DemuxStatistic &stat) override;
+
+    void GetAdaptiveStatistic(AdaptiveStatistic &stat) override;
+
     void Close() override;
 
+    // set before Open(), shared by every extractor of the player
+    void SetProbeCache(std::shared_ptr<ProbeCache> cache);
+
+    // set before Open(), network sources are then read through the disk cache
+    void SetDiskCache(std::shared_ptr<DiskCache> cache);
+
 private:
     static int InterruptCallback(void *opaque);
 
+    // arm the deadline of an open phase, 0: none
+    void BeginPhase(int64_t timeoutUs);
+
+    // disarm it, a failure is turned into timeoutCode or ERROR_PLAYER_ABORT
+    int EndPhase(int ret, int timeoutCode, int32_t *costMs);
+
+    void UpdateStreamState();
+
+    // false if the packet belongs to an unselected track or was returned before
+    bool AcceptPacket(const AVPacket *pkt);
+
+    int SeekTo(int64_t timestamp, int64_t seekMin, int64_t seekMax, int seekFlags);
+
+    void SetupKeyframeIndex(const ProbeCacheEntry *entry);
+
+    int OpenIO(const std::string &url, FFmpegOption &opt);
+
+    ProbeValidator GetValidator(const std::string &url);
+
+    // verify: check the entry against the header, for sources without mtime
+    bool ApplyProbeCache(const ProbeCacheEntry &entry, bool verify, bool *needProbe);
+
+    static bool MatchHeader(const AVCodecParameters *par, const TrackInfo &info);
+
     void NotifyListener(int32_t what, int32_t arg1 = 0, int32_t arg2 = 0,
                         void *obj = nullptr, int len = 0);
 
@@ -43,6 +103,41 @@ private:
     NotifyCallback mNotifyCb;
     std::atomic_bool bAbort {false};
     AVFormatContext *mFormatCtx = nullptr;
+    AVIOContext *mProtocolCtx = nullptr;
+
+    std::thread mOpenThread;
+    std::atomic<int64_t> mDeadlineUs {0};
+    int64_t mPhaseStartUs = 0;
+
+    std::unique_ptr<ReadAheadIO> mReadAhead;
+    std::unique_ptr<DiskCacheIO> mDiskCacheIO;
+    std::unique_ptr<MmapIO> mMmapIO;
+    std::unique_ptr<AdaptiveIO> mAdaptiveIO;
+    // resolution of the variant being read, to report a change on switch
+    int mVariantWidth  = 0;
+    int mVariantHeight = 0;
+    std::shared_ptr<DiskCache> mDiskCache;
+    std::shared_ptr<ProbeCache> mProbeCache;
+    bool bProbeCacheHit = false;
+    bool bFirstPacket = true;
+    int64_t mOpenTimeUs = 0;
+
+    int mPendingError = 0;
+    // codec_type by stream index, saves a lookup per batched packet
+    std::vector<int> mStreamTypes;
+    // dts of the last returned packet, and the dts to skip up to after a track switch
+    std::vector<int64_t> mLastDts;
+    std::vector<int64_t> mResyncDts;
+    int64_t mLastTimeUs = AV_NOPTS_VALUE;
+    std::atomic<int64_t> mReadBytes {0};
+    std::atomic<int64_t> mConsumedBytes {0};
+    std::atomic<int64_t> mDroppedPackets {0};
+
+    std::string mUrl;
+    ProbeValidator mValidator;
+    // built on the parser thread, used by Seek on the same thread
+    bool bIndexSeek = false;
+    KeyframeIndex mKeyIndex;
 
 };
 
@@ -0,0 +1,351 @@
+/**
+ * Note: cache of stream probing result
+ * Date: 2026/10/18
+ */
+
+#include "ProbeCache.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+#include "NextLog.h"
+
+#define TAG "ProbeCache"
+
+#define PROBE_CACHE_MAGIC 0x4E505242 // NPRB
+#define PROBE_CACHE_MAX_TRACK 64
+#define PROBE_CACHE_MAX_EXTRA (1 << 20)
+#define PROBE_CACHE_SUFFIX ".probe"
+
+template<typename T>
+static bool WriteValue(FILE *fp, const T &value) {
+    return fwrite(&value, sizeof(T), 1, fp) == 1;
+}
+
+template<typename T>
+static bool ReadValue(FILE *fp, T &value) {
+    return fread(&value, sizeof(T), 1, fp) == 1;
+}
+
+struct ValueWriter {
+    FILE *fp;
+
+    template<typename T>
+    bool operator()(const T &value) const {
+        return WriteValue(fp, value);
+    }
+};
+
+struct ValueReader {
+    FILE *fp;
+
+    template<typename T>
+    bool operator()(T &value) const {
+        return ReadValue(fp, value);
+    }
+};
+
+// every field of TrackInfo but the extra data, in file order
+template<typename Track, typename Func>
+static bool VisitTrack(Track &info, const Func &func) {
+    return func(info.codec_id) && func(info.stream_type) && func(info.stream_index)
+           && func(info.codec_profile) && func(info.bit_rate)
+           && func(info.width) && func(info.height) && func(info.sar_num) && func(info.sar_den)
+           && func(info.fps_num) && func(info.fps_den) && func(info.tbr_num) && func(info.tbr_den)
+           && func(info.rotation) && func(info.pixel_fmt)
+           && func(info.color_space) && func(info.color_range)
+           && func(info.color_transfer) && func(info.color_primaries)
+           && func(info.channels) && func(info.sample_fmt) && func(info.sample_rate)
+           && func(info.time_base_num) && func(info.time_base_den);
+}
+
+ProbeCache::ProbeCache(const std::string &cacheDir, int maxFiles)
+        : mCacheDir(cacheDir), mMaxFiles(std::max(maxFiles, 1)) {
+    if (!mCacheDir.empty() && mCacheDir.back() != '/') {
+        mCacheDir += '/';
+    }
+}
+
+bool ProbeCache::Lookup(const std::string &url, const ProbeValidator &validator,
+                        ProbeCacheEntry &entry) {
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mEntries.find(url);
+    if (it == mEntries.end()) {
+        std::shared_ptr<ProbeCacheEntry> loaded(new ProbeCacheEntry());
+        if (!Load(url, *loaded)) {
+            return false;
+        }
+        Evict();
+        loaded->access = ++mAccessTick;
+        it = mEntries.emplace(url, loaded).first;
+    }
+    if (!Match(it->second->validator, validator)) {
+        NEXT_LOGI(TAG, "stale entry, size=%lld mtime=%lld\n",
+                  (long long) validator.size, (long long) validator.mtime);
+        mEntries.erase(it);
+        return false;
+    }
+    it->second->access = ++mAccessTick;
+    entry = *it->second;
+    return true;
+}
+
+void ProbeCache::Store(const std::string &url, const ProbeValidator &validator,
+                       const MetaData &metadata) {
+    std::shared_ptr<ProbeCacheEntry> entry(new ProbeCacheEntry());
+    entry->url        = url;
+    entry->validator  = validator;
+    entry->duration   = metadata.duration;
+    entry->bit_rate   = metadata.bit_rate;
+    entry->start_time = metadata.start_time;
+    entry->track_info = metadata.track_info;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mEntries.find(url);
+    // keyframes learned by an earlier playback of the same version stay
+    if (it != mEntries.end() && Match(it->second->validator, validator)) {
+        entry->keyframe_stream = it->second->keyframe_stream;
+        entry->keyframes = it->second->keyframes;
+    }
+    if (it == mEntries.end()) {
+        Evict();
+    }
+    entry->access = ++mAccessTick;
+    mEntries[url] = entry;
+    if (mCacheDir.empty()) {
+        return;
+    }
+    if (!Save(*entry)) {
+        NEXT_LOGW(TAG, "save probe cache fail: %s\n", CachePath(url).c_str());
+        return;
+    }
+    TrimFiles(CachePath(url));
+}
+
+void ProbeCache::StoreKeyframes(const std::string &url, const ProbeValidator &validator,
+                                const KeyframeIndex &index) {
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mEntries.find(url);
+    if (it == mEntries.end()) {
+        // evicted from memory while playing, the file still has it
+        std::shared_ptr<ProbeCacheEntry> loaded(new ProbeCacheEntry());
+        if (!Load(url, *loaded)) {
+            return;
+        }
+        Evict();
+        loaded->access = ++mAccessTick;
+        it = mEntries.emplace(url, loaded).first;
+    }
+    if (!Match(it->second->validator, validator)) {
+        return;
+    }
+    it->second->keyframe_stream = index.StreamIndex();
+    it->second->keyframes = index.Entries();
+    if (!mCacheDir.empty() && !Save(*it->second)) {
+        NEXT_LOGW(TAG, "save keyframes fail: %s\n", CachePath(url).c_str());
+    }
+}
+
+void ProbeCache::Remove(const std::string &url) {
+    std::lock_guard<std::mutex> lock(mLock);
+    mEntries.erase(url);
+    if (!mCacheDir.empty()) {
+        remove(CachePath(url).c_str());
+    }
+}
+
+void ProbeCache::ToMetaData(const ProbeCacheEntry &entry, MetaData &metadata) {
+    metadata.duration   = entry.duration;
+    metadata.bit_rate   = entry.bit_rate;
+    metadata.start_time = entry.start_time;
+    metadata.track_info = entry.track_info;
+}
+
+ProbeValidator ProbeCache::LocalValidator(const std::string &url) {
+    ProbeValidator validator;
+    std::string path = url;
+    if (path.compare(0, 5, "file:") == 0) {
+        path = path.substr(5);
+    } else if (path.find("://") != std::string::npos) {
+        return validator;
+    }
+    struct stat st {};
+    if (stat(path.c_str(), &st) == 0) {
+        validator.size  = static_cast<int64_t>(st.st_size);
+        validator.mtime = static_cast<int64_t>(st.st_mtime);
+    }
+    return validator;
+}
+
+std::string ProbeCache::CachePath(const std::string &url) const {
+    char name[32] = {0};
+    snprintf(name, sizeof(name), "%016zx" PROBE_CACHE_SUFFIX, std::hash<std::string>()(url));
+    return mCacheDir + name;
+}
+
+bool ProbeCache::Load(const std::string &url, ProbeCacheEntry &entry) {
+    if (mCacheDir.empty()) {
+        return false;
+    }
+    FILE *fp = fopen(CachePath(url).c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+
+    bool ok = false;
+    do {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t urlLen = 0;
+        if (!ReadValue(fp, magic) || !ReadValue(fp, version)
+            || magic != PROBE_CACHE_MAGIC || version != PROBE_CACHE_VERSION) {
+            break;
+        }
+        if (!ReadValue(fp, urlLen) || urlLen != url.size()) {
+            break;
+        }
+        entry.url.resize(urlLen);
+        if (urlLen > 0 && fread(&entry.url[0], 1, urlLen, fp) != urlLen) {
+            break;
+        }
+        // different urls may share a hash
+        if (entry.url != url) {
+            break;
+        }
+
+        uint32_t trackCount = 0;
+        if (!ReadValue(fp, entry.validator) || !ReadValue(fp, entry.duration)
+            || !ReadValue(fp, entry.bit_rate) || !ReadValue(fp, entry.start_time)
+            || !ReadValue(fp, trackCount) || trackCount > PROBE_CACHE_MAX_TRACK) {
+            break;
+        }
+        uint32_t i = 0;
+        for (; i < trackCount; i++) {
+            TrackInfo info;
+            uint32_t extraSize = 0;
+            if (!VisitTrack(info, ValueReader {fp}) || !ReadValue(fp, extraSize)
+                || extraSize > PROBE_CACHE_MAX_EXTRA) {
+                break;
+            }
+            std::vector<uint8_t> extra(extraSize);
+            if (extraSize > 0 && fread(extra.data(), 1, extraSize, fp) != extraSize) {
+                break;
+            }
+            info.extra_data = MakeExtraData(extra.data(), static_cast<int>(extraSize));
+            entry.track_info.push_back(info);
+        }
+        if (i != trackCount) {
+            break;
+        }
+
+        uint32_t keyCount = 0;
+        if (!ReadValue(fp, entry.keyframe_stream) || !ReadValue(fp, keyCount)
+            || keyCount > KEYFRAME_INDEX_MAX) {
+            break;
+        }
+        entry.keyframes.resize(keyCount);
+        ok = keyCount == 0
+             || fread(entry.keyframes.data(), sizeof(KeyframeEntry), keyCount, fp) == keyCount;
+    } while (false);
+
+    fclose(fp);
+    if (!ok) {
+        NEXT_LOGW(TAG, "drop corrupted probe cache: %s\n", CachePath(url).c_str());
+        remove(CachePath(url).c_str());
+    }
+    return ok;
+}
+
+bool ProbeCache::Save(const ProbeCacheEntry &entry) {
+    std::string path = CachePath(entry.url);
+    std::string tmpPath = path + ".tmp";
+    FILE *fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+
+    auto urlLen     = static_cast<uint32_t>(entry.url.size());
+    auto trackCount = static_cast<uint32_t>(entry.track_info.size());
+    bool ok = WriteValue(fp, (uint32_t) PROBE_CACHE_MAGIC)
+              && WriteValue(fp, (uint32_t) PROBE_CACHE_VERSION)
+              && WriteValue(fp, urlLen)
+              && fwrite(entry.url.data(), 1, urlLen, fp) == urlLen
+              && WriteValue(fp, entry.validator)
+              && WriteValue(fp, entry.duration)
+              && WriteValue(fp, entry.bit_rate)
+              && WriteValue(fp, entry.start_time)
+              && WriteValue(fp, trackCount);
+    for (uint32_t i = 0; ok && i < trackCount; i++) {
+        const TrackInfo &info = entry.track_info[i];
+        auto extraSize = static_cast<uint32_t>(info.extra_data ? info.extra_data->size() : 0);
+        ok = VisitTrack(info, ValueWriter {fp}) && WriteValue(fp, extraSize)
+             && (extraSize == 0 || fwrite(info.extra_data->data(), 1, extraSize, fp) == extraSize);
+    }
+    auto keyCount = static_cast<uint32_t>(entry.keyframes.size());
+    ok = ok && WriteValue(fp, entry.keyframe_stream) && WriteValue(fp, keyCount)
+         && fwrite(entry.keyframes.data(), sizeof(KeyframeEntry), keyCount, fp) == keyCount;
+
+    ok = (fclose(fp) == 0) && ok;
+    // rename so that a reader never sees a partial file
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void ProbeCache::Evict() {
+    // only the memory copy goes, the file is kept for the next lookup
+    while (mEntries.size() >= PROBE_CACHE_MAX_ENTRY) {
+        auto oldest = mEntries.begin();
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+            if (it->second->access < oldest->second->access) {
+                oldest = it;
+            }
+        }
+        mEntries.erase(oldest);
+    }
+}
+
+void ProbeCache::TrimFiles(const std::string &keep) {
+    DIR *dir = opendir(mCacheDir.c_str());
+    if (!dir) {
+        return;
+    }
+    // mtime and path of every probe file but the one just written
+    std::vector<std::pair<int64_t, std::string>> files;
+    size_t suffixLen = strlen(PROBE_CACHE_SUFFIX);
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != nullptr) {
+        std::string name = ent->d_name;
+        if (name.size() <= suffixLen
+            || name.compare(name.size() - suffixLen, suffixLen, PROBE_CACHE_SUFFIX) != 0) {
+            continue;
+        }
+        std::string path = mCacheDir + name;
+        struct stat st {};
+        if (path != keep && stat(path.c_str(), &st) == 0) {
+            files.emplace_back(static_cast<int64_t>(st.st_mtime), path);
+        }
+    }
+    closedir(dir);
+
+    int excess = static_cast<int>(files.size()) + 1 - mMaxFiles;
+    if (excess <= 0) {
+        return;
+    }
+    std::sort(files.begin(), files.end());
+    for (int i = 0; i < excess; i++) {
+        remove(files[i].second.c_str());
+    }
+    NEXT_LOGI(TAG, "trim %d probe files\n", excess);
+}
+
+bool ProbeCache::Match(const ProbeValidator &a, const ProbeValidator &b) {
+    return a.size == b.size && a.mtime == b.mtime;
+}
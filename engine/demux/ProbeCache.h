@@ -0,0 +1,91 @@
+#ifndef PROBE_CACHE_H
+#define PROBE_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "KeyframeIndex.h"
+#include "NextStructDefine.h"
+
+#define PROBE_CACHE_VERSION 3
+#define PROBE_CACHE_MAX_ENTRY 64
+// files in the cache directory, the oldest written go first
+#define PROBE_CACHE_MAX_FILE 256
+
+// identify a version of the source, -1/0 mean unknown
+struct ProbeValidator {
+    int64_t size  = -1;
+    int64_t mtime = 0;
+};
+
+struct ProbeCacheEntry {
+    std::string url;
+    ProbeValidator validator;
+    int64_t duration   = 0;
+    int64_t bit_rate   = 0;
+    int64_t start_time = 0;
+    // extra data is shared with the metadata, never copied
+    std::vector<TrackInfo> track_info;
+    int keyframe_stream = -1;
+    std::vector<KeyframeEntry> keyframes;
+    // last use, for LRU in memory, not saved
+    uint64_t access = 0;
+};
+
+/**
+ * Cache the result of stream probing, keyed by url and validated by
+ * size/mtime, so that reopening a source can skip find_stream_info.
+ * Network sources have no mtime, so a hit on them must still be checked
+ * against what the demuxer read from the header.
+ * Entries live in memory and, when a directory is given, on disk.
+ */
+class ProbeCache {
+public:
+    explicit ProbeCache(const std::string &cacheDir = "", int maxFiles = PROBE_CACHE_MAX_FILE);
+
+    // false if missing or the validator doesn't match
+    bool Lookup(const std::string &url, const ProbeValidator &validator,
+                ProbeCacheEntry &entry);
+
+    void Store(const std::string &url, const ProbeValidator &validator,
+               const MetaData &metadata);
+
+    // keyframes are learned while playing, saved apart from the probe result
+    void StoreKeyframes(const std::string &url, const ProbeValidator &validator,
+                        const KeyframeIndex &index);
+
+    void Remove(const std::string &url);
+
+    static void ToMetaData(const ProbeCacheEntry &entry, MetaData &metadata);
+
+    // size/mtime of a local file, unknown for network urls
+    static ProbeValidator LocalValidator(const std::string &url);
+
+private:
+    std::string CachePath(const std::string &url) const;
+
+    bool Load(const std::string &url, ProbeCacheEntry &entry);
+
+    bool Save(const ProbeCacheEntry &entry);
+
+    // must hold mLock, drop the least recently used entries from memory
+    void Evict();
+
+    // must hold mLock, remove the oldest files above mMaxFiles but keep
+    void TrimFiles(const std::string &keep);
+
+    static bool Match(const ProbeValidator &a, const ProbeValidator &b);
+
+private:
+    std::mutex mLock;
+    std::string mCacheDir;
+    int mMaxFiles = PROBE_CACHE_MAX_FILE;
+    uint64_t mAccessTick = 0;
+    std::map<std::string, std::shared_ptr<ProbeCacheEntry>> mEntries;
+};
+
+#endif //PROBE_CACHE_H
@@ -0,0 +1,283 @@
+/**
+ * Note: read-ahead layer between the protocol and the demuxer
+ * Date: 2026/10/18
+ */
+
+#include "ReadAheadIO.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "NextLog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/mem.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define TAG "ReadAheadIO"
+
+ReadAheadIO::~ReadAheadIO() {
+    Close();
+}
+
+int ReadAheadIO::Open(const std::string &url, AVDictionary *options,
+                      const AVIOInterruptCB &interruptCb, int64_t capacity) {
+    // avio_open2 consumes the protocol options, keep the caller's dict intact
+    AVDictionary *opts = nullptr;
+    av_dict_copy(&opts, options, 0);
+    int ret = avio_open2(&mInnerCtx, url.c_str(), AVIO_FLAG_READ, &interruptCb, &opts);
+    av_dict_free(&opts);
+    if (ret < 0) {
+        NEXT_LOGE(TAG, "avio_open2 error, ret=%d\n", ret);
+        return ret;
+    }
+    bOwnInner = true;
+    return Open(mInnerCtx, capacity);
+}
+
+int ReadAheadIO::Open(AVIOContext *inner, int64_t capacity) {
+    mInnerCtx = inner;
+    mFileSize = avio_size(mInnerCtx);
+    mCapacity = std::min(std::max(capacity, (int64_t) READ_AHEAD_MIN_SIZE),
+                         (int64_t) READ_AHEAD_MAX_SIZE);
+    mRing.resize(mCapacity);
+
+    auto *buffer = static_cast<uint8_t *>(av_malloc(READ_AHEAD_AVIO_SIZE));
+    mAvioCtx = buffer ? avio_alloc_context(buffer, READ_AHEAD_AVIO_SIZE, 0, this,
+                                           ReadPacket, nullptr, SeekPacket) : nullptr;
+    if (!mAvioCtx) {
+        av_free(buffer);
+        Close();
+        return AVERROR(ENOMEM);
+    }
+    mAvioCtx->seekable = mInnerCtx->seekable;
+
+    mThread = std::thread(&ReadAheadIO::ReadThread, this);
+    NEXT_LOGI(TAG, "open, size=%lld, capacity=%lld\n",
+              (long long) mFileSize, (long long) mCapacity);
+    return 0;
+}
+
+AVIOContext *ReadAheadIO::GetContext() {
+    return mAvioCtx;
+}
+
+void ReadAheadIO::SetCapacity(int64_t capacity) {
+    std::lock_guard<std::mutex> lock(mLock);
+    capacity = std::min(std::max(capacity, (int64_t) READ_AHEAD_MIN_SIZE),
+                        (int64_t) READ_AHEAD_MAX_SIZE);
+    // never drop data the demuxer hasn't read yet
+    capacity = std::max(capacity, mBufEnd - mReadPos);
+    if (capacity == mCapacity || mRing.empty()) {
+        return;
+    }
+
+    int64_t start = std::max(mBufStart, mBufEnd - capacity);
+    std::vector<uint8_t> data(static_cast<size_t>(mBufEnd - start));
+    CopyFromRing(data.data(), start, static_cast<int>(data.size()));
+    std::vector<uint8_t>(static_cast<size_t>(capacity)).swap(mRing);
+    mCapacity = capacity;
+    mBufStart = start;
+    CopyToRing(data.data(), start, static_cast<int>(data.size()));
+    mCond.notify_all();
+    NEXT_LOGI(TAG, "capacity=%lld\n", (long long) mCapacity);
+}
+
+int64_t ReadAheadIO::CapacityOfBitrate(int64_t bitRate) {
+    if (bitRate <= 0) {
+        return READ_AHEAD_DEFAULT_SIZE;
+    }
+    return bitRate / 8 * READ_AHEAD_SECONDS;
+}
+
+void ReadAheadIO::GetStatistic(IOCacheStatistic &stat) {
+    std::lock_guard<std::mutex> lock(mLock);
+    stat.file_pos   = mBufEnd;
+    stat.cache_size = mBufEnd - mReadPos;
+    stat.file_size  = mFileSize;
+}
+
+void ReadAheadIO::Abort() {
+    std::lock_guard<std::mutex> lock(mLock);
+    bAbort = true;
+    mCond.notify_all();
+}
+
+void ReadAheadIO::Close() {
+    Abort();
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+    if (mAvioCtx) {
+        av_freep(&mAvioCtx->buffer);
+        avio_context_free(&mAvioCtx);
+    }
+    if (bOwnInner) {
+        avio_closep(&mInnerCtx);
+    }
+    mInnerCtx = nullptr;
+    std::vector<uint8_t>().swap(mRing);
+}
+
+int ReadAheadIO::ReadPacket(void *opaque, uint8_t *buf, int size) {
+    return static_cast<ReadAheadIO *>(opaque)->Read(buf, size);
+}
+
+int64_t ReadAheadIO::SeekPacket(void *opaque, int64_t offset, int whence) {
+    return static_cast<ReadAheadIO *>(opaque)->Seek(offset, whence);
+}
+
+int ReadAheadIO::Read(uint8_t *buf, int size) {
+    std::unique_lock<std::mutex> lock(mLock);
+    mCond.wait(lock, [this] {
+        return bAbort || mReadPos < mBufEnd || bEof || mError < 0;
+    });
+    if (mReadPos < mBufEnd) {
+        int len = static_cast<int>(std::min((int64_t) size, mBufEnd - mReadPos));
+        CopyFromRing(buf, mReadPos, len);
+        mReadPos += len;
+        mCond.notify_all();
+        return len;
+    }
+    if (bAbort) {
+        return AVERROR_EXIT;
+    }
+    return mError < 0 ? mError : AVERROR_EOF;
+}
+
+int64_t ReadAheadIO::Seek(int64_t offset, int whence) {
+    std::unique_lock<std::mutex> lock(mLock);
+    if (whence & AVSEEK_SIZE) {
+        return mFileSize >= 0 ? mFileSize : AVERROR(ENOSYS);
+    }
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = mReadPos + offset;
+            break;
+        case SEEK_END:
+            if (mFileSize < 0) {
+                return AVERROR(ENOSYS);
+            }
+            target = mFileSize + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+
+    // inside the buffered range, no protocol seek
+    if (target >= mBufStart && target <= mBufEnd) {
+        mReadPos = target;
+        mCond.notify_all();
+        return target;
+    }
+
+    // the window moves only once the protocol is there, a failed seek
+    // keeps the buffered data and the read position
+    int serial = ++mSeekSerial;
+    mSeekReq = target;
+    mCond.notify_all();
+    mCond.wait(lock, [this, serial] { return bAbort || mSeekDone == serial; });
+    if (bAbort) {
+        return AVERROR_EXIT;
+    }
+    return mSeekResult;
+}
+
+void ReadAheadIO::ReadThread() {
+    std::vector<uint8_t> chunk(READ_AHEAD_CHUNK_SIZE);
+    std::unique_lock<std::mutex> lock(mLock);
+    while (!bAbort) {
+        if (mSeekReq >= 0) {
+            int64_t target = mSeekReq;
+            int serial = mSeekSerial;
+            mSeekReq = -1;
+            lock.unlock();
+            int64_t ret = avio_seek(mInnerCtx, target, SEEK_SET);
+            int64_t restore = 0;
+            if (ret < 0 && avio_tell(mInnerCtx) != mBufEnd) {
+                // mBufEnd only moves on this thread, reading goes on from there
+                restore = avio_seek(mInnerCtx, mBufEnd, SEEK_SET);
+            }
+            lock.lock();
+            if (ret >= 0) {
+                mBufStart = target;
+                mReadPos  = target;
+                mBufEnd   = target;
+                mError    = 0;
+                bEof      = false;
+            } else {
+                NEXT_LOGE(TAG, "seek to %lld error, ret=%lld\n", (long long) target, (long long) ret);
+                if (restore < 0) {
+                    mError = static_cast<int>(restore);
+                }
+            }
+            mSeekResult = ret < 0 ? ret : target;
+            mSeekDone = serial;
+            mCond.notify_all();
+            continue;
+        }
+
+        int64_t space = ForwardLimit() - (mBufEnd - mReadPos);
+        if (bEof || mError < 0 || space <= 0) {
+            mCond.wait(lock);
+            continue;
+        }
+
+        int size = static_cast<int>(std::min(space, (int64_t) chunk.size()));
+        int64_t pos = mBufEnd;
+        lock.unlock();
+        int ret = avio_read(mInnerCtx, chunk.data(), size);
+        lock.lock();
+        // seeks run on this thread, a request posted meanwhile hasn't moved the
+        // protocol yet: the data still follows mBufEnd, keep it in case the seek fails
+        if (ret > 0) {
+            CopyToRing(chunk.data(), pos, ret);
+            mBufEnd += ret;
+            mBufStart = std::max(mBufStart, mBufEnd - mCapacity);
+        } else if (ret == 0 || ret == AVERROR_EOF) {
+            bEof = true;
+        } else {
+            NEXT_LOGE(TAG, "avio_read error, ret=%d\n", ret);
+            mError = ret;
+        }
+        mCond.notify_all();
+    }
+}
+
+void ReadAheadIO::CopyToRing(const uint8_t *src, int64_t pos, int size) {
+    while (size > 0) {
+        auto offset = static_cast<size_t>(pos % mCapacity);
+        int len = static_cast<int>(std::min((int64_t) size, mCapacity - (int64_t) offset));
+        memcpy(mRing.data() + offset, src, len);
+        src  += len;
+        pos  += len;
+        size -= len;
+    }
+}
+
+void ReadAheadIO::CopyFromRing(uint8_t *dst, int64_t pos, int size) {
+    while (size > 0) {
+        auto offset = static_cast<size_t>(pos % mCapacity);
+        int len = static_cast<int>(std::min((int64_t) size, mCapacity - (int64_t) offset));
+        memcpy(dst, mRing.data() + offset, len);
+        dst  += len;
+        pos  += len;
+        size -= len;
+    }
+}
+
+int64_t ReadAheadIO::ForwardLimit() const {
+    // the rest stays behind the read position for backward seeks
+    return mCapacity - mCapacity / 4;
+}
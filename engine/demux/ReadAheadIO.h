@@ -0,0 +1,103 @@
+#ifndef READ_AHEAD_IO_H
+#define READ_AHEAD_IO_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NextStructDefine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavformat/avio.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define READ_AHEAD_MIN_SIZE     (2 * 1024 * 1024)
+#define READ_AHEAD_MAX_SIZE     (32 * 1024 * 1024)
+#define READ_AHEAD_DEFAULT_SIZE (4 * 1024 * 1024)
+#define READ_AHEAD_SECONDS      10
+#define READ_AHEAD_CHUNK_SIZE   (64 * 1024)
+#define READ_AHEAD_AVIO_SIZE    (32 * 1024)
+
+/**
+ * AVIOContext that is filled by a background thread from the real protocol,
+ * so that network stalls don't block av_read_frame until the buffer drains.
+ * The ring keeps a quarter of its capacity behind the read position,
+ * seeking inside the buffered range doesn't touch the protocol.
+ */
+class ReadAheadIO {
+public:
+    ReadAheadIO() = default;
+
+    ~ReadAheadIO();
+
+    int Open(const std::string &url, AVDictionary *options,
+             const AVIOInterruptCB &interruptCb, int64_t capacity = READ_AHEAD_DEFAULT_SIZE);
+
+    // read ahead of another io layer, which must outlive Close()
+    int Open(AVIOContext *inner, int64_t capacity = READ_AHEAD_DEFAULT_SIZE);
+
+    // owned by ReadAheadIO, assign to AVFormatContext::pb before avformat_open_input
+    AVIOContext *GetContext();
+
+    // resize with the bitrate after probing, buffered data is kept
+    void SetCapacity(int64_t capacity);
+
+    static int64_t CapacityOfBitrate(int64_t bitRate);
+
+    void GetStatistic(IOCacheStatistic &stat);
+
+    void Abort();
+
+    void Close();
+
+private:
+    static int ReadPacket(void *opaque, uint8_t *buf, int size);
+
+    static int64_t SeekPacket(void *opaque, int64_t offset, int whence);
+
+    int Read(uint8_t *buf, int size);
+
+    int64_t Seek(int64_t offset, int whence);
+
+    void ReadThread();
+
+    // the ring maps a file offset to offset % capacity
+    void CopyToRing(const uint8_t *src, int64_t pos, int size);
+
+    void CopyFromRing(uint8_t *dst, int64_t pos, int size);
+
+    int64_t ForwardLimit() const;
+
+private:
+    std::mutex mLock;
+    std::condition_variable mCond;
+    std::thread mThread;
+
+    AVIOContext *mInnerCtx = nullptr;
+    AVIOContext *mAvioCtx  = nullptr;
+    bool bOwnInner = false;
+
+    std::vector<uint8_t> mRing;
+    int64_t mCapacity = 0;
+    int64_t mFileSize = -1;
+    int64_t mBufStart = 0; // oldest retained byte
+    int64_t mReadPos  = 0; // next byte of the demuxer
+    int64_t mBufEnd   = 0; // next byte to fetch
+
+    int64_t mSeekReq = -1;
+    int64_t mSeekResult = 0;
+    int mSeekSerial  = 0;
+    int mSeekDone    = 0;
+    int mError       = 0;
+    bool bEof        = false;
+    bool bAbort      = false;
+};
+
+#endif //READ_AHEAD_IO_H
@@ -0,0 +1,166 @@
+/**
+ * Note: adaptive A/V sync controller
+ * Date: 2026/10/18
+ */
+
+#include "AVSyncController.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CommonUtil.h"
+
+// bucket edges in ms, the first and last bucket are open ended
+static const int kDriftHistogramEdges[DRIFT_HISTOGRAM_SIZE - 1] = {
+        -100, -40, -20, -10, -5, 5, 10, 20, 40, 100
+};
+
+void SlidingWindow::Reset() {
+    mCount = 0;
+    mIndex = 0;
+}
+
+void SlidingWindow::Add(double value) {
+    mSamples[mIndex] = value;
+    mIndex = (mIndex + 1) % SYNC_WINDOW_SIZE;
+    mCount = std::min(mCount + 1, SYNC_WINDOW_SIZE);
+}
+
+double SlidingWindow::Mean() const {
+    if (mCount <= 0) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (int i = 0; i < mCount; i++) {
+        sum += mSamples[i];
+    }
+    return sum / mCount;
+}
+
+double SlidingWindow::StdDev() const {
+    if (mCount <= 1) {
+        return 0.0;
+    }
+    double mean = Mean();
+    double sum  = 0.0;
+    for (int i = 0; i < mCount; i++) {
+        sum += (mSamples[i] - mean) * (mSamples[i] - mean);
+    }
+    return sqrt(sum / (mCount - 1));
+}
+
+int SlidingWindow::Count() const {
+    return mCount;
+}
+
+void AVSyncController::Reset() {
+    std::lock_guard<std::mutex> lock(mLock);
+    mContinueDrop  = 0;
+    mLastRenderUs  = 0;
+    mSyncThreshold = AV_SYNC_THRESHOLD_MIN;
+    mDropThreshold = FRAME_DROP_THRESHOLD;
+    mDriftSum      = 0.0;
+    mLatencyWindow.Reset();
+    mJitterWindow.Reset();
+    mStat = AVSyncStatistic();
+}
+
+void AVSyncController::UpdateAudioLatency(double latency) {
+    if (std::isnan(latency) || latency < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mLock);
+    mLatencyWindow.Add(latency);
+    UpdateThresholds();
+}
+
+void AVSyncController::OnFrameRendered(double frameDuration) {
+    int64_t now = SteadyTimeUs();
+    std::lock_guard<std::mutex> lock(mLock);
+    mContinueDrop = 0;
+    if (mLastRenderUs > 0 && frameDuration > 0 && frameDuration < MAX_FRAME_DURATION) {
+        double interval = static_cast<double>(now - mLastRenderUs) / 1000000.0;
+        // pauses and seeks are not jitter
+        if (interval < frameDuration * 4) {
+            mJitterWindow.Add(interval - frameDuration);
+            UpdateThresholds();
+        }
+    }
+    mLastRenderUs = now;
+}
+
+double AVSyncController::ComputeTargetDelay(double delay, double diff) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (std::isnan(diff) || fabs(diff) >= MAX_FRAME_DURATION) {
+        return delay;
+    }
+    RecordDrift(diff);
+
+    double threshold = std::max(mSyncThreshold, std::min(AV_SYNC_THRESHOLD_MAX, delay));
+    if (diff <= -threshold) {
+        delay = std::max(0.0, delay + diff);
+    } else if (diff >= threshold && delay > AV_SYNC_FRAMEDUP_THRESHOLD) {
+        delay = delay + diff;
+    } else if (diff >= threshold) {
+        delay = 2 * delay;
+    }
+    return delay;
+}
+
+bool AVSyncController::ShouldDropFrame(double lateness, double frameDuration) {
+    std::lock_guard<std::mutex> lock(mLock);
+    // lateness below one frame plus the noise margin is display noise, not a late frame
+    double frame = frameDuration > 0 && frameDuration < MAX_FRAME_DURATION ? frameDuration : 0;
+    double threshold = frame + mDropThreshold;
+    if (lateness <= threshold || mContinueDrop >= MAX_CONTINUE_DROP_FRAME) {
+        return false;
+    }
+    mContinueDrop++;
+    return true;
+}
+
+double AVSyncController::GetRefreshInterval(double frameDuration) {
+    if (frameDuration <= 0 || frameDuration >= MAX_FRAME_DURATION) {
+        return REFRESH_RATE;
+    }
+    return std::min(REFRESH_RATE, frameDuration / 2);
+}
+
+double AVSyncController::GetAudioDiffThreshold() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return std::max(AV_SYNC_THRESHOLD_MIN, 2 * mLatencyWindow.StdDev());
+}
+
+void AVSyncController::GetStatistic(AVSyncStatistic &stat) {
+    std::lock_guard<std::mutex> lock(mLock);
+    stat = mStat;
+}
+
+void AVSyncController::UpdateThresholds() {
+    double latencyJitter = mLatencyWindow.StdDev();
+    double renderJitter  = mJitterWindow.StdDev();
+    double noise = renderJitter + latencyJitter;
+
+    mSyncThreshold = std::min(std::max(AV_SYNC_THRESHOLD_MIN, 2 * noise), AV_SYNC_THRESHOLD_MAX);
+    // a steady renderer must not shrink the margin to nothing
+    mDropThreshold = std::min(std::max(AV_SYNC_THRESHOLD_MIN, 3 * noise), FRAME_DROP_THRESHOLD);
+
+    mStat.audio_latency  = static_cast<float>(mLatencyWindow.Mean());
+    mStat.latency_jitter = static_cast<float>(latencyJitter);
+    mStat.render_jitter  = static_cast<float>(renderJitter);
+    mStat.sync_threshold = static_cast<float>(mSyncThreshold);
+    mStat.drop_threshold = static_cast<float>(mDropThreshold);
+}
+
+void AVSyncController::RecordDrift(double diff) {
+    double driftMs = diff * 1000.0;
+    int bucket = 0;
+    while (bucket < DRIFT_HISTOGRAM_SIZE - 1 && driftMs >= kDriftHistogramEdges[bucket]) {
+        bucket++;
+    }
+    mStat.drift_histogram[bucket]++;
+    mStat.drift_samples++;
+    mDriftSum += fabs(driftMs);
+    mStat.drift_avg = static_cast<float>(mDriftSum / static_cast<double>(mStat.drift_samples));
+    mStat.drift_max = std::max(mStat.drift_max, static_cast<float>(fabs(driftMs)));
+}
@@ -0,0 +1,102 @@
+#ifndef AV_SYNC_CONTROLLER_H
+#define AV_SYNC_CONTROLLER_H
+
+#include <cstdint>
+#include <mutex>
+
+// render rate
+#define REFRESH_RATE 0.01
+#define MAX_FRAME_DURATION 10.0
+#define FRAME_DROP_THRESHOLD 0.15
+#define AV_SYNC_THRESHOLD_MIN 0.04
+#define AV_SYNC_THRESHOLD_MAX 0.1
+#define AV_SYNC_FRAMEDUP_THRESHOLD 0.1
+
+#define SYNC_WINDOW_SIZE 120
+#define MAX_CONTINUE_DROP_FRAME 8
+#define DRIFT_HISTOGRAM_SIZE 11
+
+typedef struct AVSyncStatistic {
+    float audio_latency   = 0.0; // mean of AudioRender::GetDelay, second
+    float latency_jitter  = 0.0; // stddev of audio latency, second
+    float render_jitter   = 0.0; // stddev of render interval error, second
+    float sync_threshold  = 0.0; // current min sync threshold, second
+    float drop_threshold  = 0.0; // current late frame threshold, second
+    float drift_avg       = 0.0; // mean of |video - master|, ms
+    float drift_max       = 0.0; // max of |video - master|, ms
+
+    int64_t drift_samples = 0;
+    // ms: <-100, -40, -20, -10, -5, [-5, 5), 5, 10, 20, 40, >=100
+    int drift_histogram[DRIFT_HISTOGRAM_SIZE] = {0};
+} AVSyncStatistic;
+
+class SlidingWindow {
+public:
+    void Reset();
+
+    void Add(double value);
+
+    double Mean() const;
+
+    double StdDev() const;
+
+    int Count() const;
+
+private:
+    int mCount = 0;
+    int mIndex = 0;
+    double mSamples[SYNC_WINDOW_SIZE] = {0};
+};
+
+// adapt sync thresholds and drop policy to measured audio latency and render jitter
+class AVSyncController {
+public:
+    AVSyncController() = default;
+
+    ~AVSyncController() = default;
+
+    void Reset();
+
+    // latency of the audio sink, from AudioRender::GetDelay. Not called yet:
+    // until the audio render feeds it, the thresholds follow render jitter only
+    void UpdateAudioLatency(double latency);
+
+    // called after a frame is shown, frameDuration is its nominal duration
+    void OnFrameRendered(double frameDuration);
+
+    // same as ffplay's compute_target_delay, diff = video clock - master clock
+    double ComputeTargetDelay(double delay, double diff);
+
+    // lateness = now - frame display time, late beyond one frame plus 3x the
+    // jitter, kept within [AV_SYNC_THRESHOLD_MIN, FRAME_DROP_THRESHOLD], drops the frame
+    bool ShouldDropFrame(double lateness, double frameDuration);
+
+    // sleep of the render loop, short enough for high frame rate content
+    double GetRefreshInterval(double frameDuration);
+
+    // minimal A/V diff the audio path should correct, ignores latency noise
+    double GetAudioDiffThreshold();
+
+    // not copied into AVStatistic::sync_stat yet, sync_stat stays zero
+    void GetStatistic(AVSyncStatistic &stat);
+
+private:
+    void UpdateThresholds();
+
+    void RecordDrift(double diff);
+
+private:
+    std::mutex mLock;
+
+    int mContinueDrop      = 0;
+    int64_t mLastRenderUs  = 0;
+    double mSyncThreshold  = AV_SYNC_THRESHOLD_MIN;
+    double mDropThreshold  = FRAME_DROP_THRESHOLD;
+    double mDriftSum       = 0.0;
+
+    SlidingWindow mLatencyWindow;
+    SlidingWindow mJitterWindow;
+    AVSyncStatistic mStat;
+};
+
+#endif // AV_SYNC_CONTROLLER_H
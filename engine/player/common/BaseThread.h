@@ -1,6 +1,8 @@
 #ifndef BASE_THREAD_H
 #define BASE_THREAD_H
 
+#include <string>
+#include <system_error>
 #include <thread>
 
 class BaseThread {
@@ -11,50 +11,79 @@
 
 using namespace std::chrono;
 
+#define RELAXED std::memory_order_relaxed
+
 MediaClock::MediaClock()
         : mSerial(0),
           bPause(true),
           mSpeed(1.0f) {
-    mLastUpdateTime = GetCurrentTime();
-    mPtsDrift = 0 - mLastUpdateTime;
+    double now = GetCurrentTime();
+    mLastUpdateTime = now;
+    mPtsDrift = 0 - now;
 }
 
 void MediaClock::SetClock(double pts) {
-    std::lock_guard<std::mutex> lock(mLock);
+    std::lock_guard<std::mutex> lock(mWriteLock);
     double now = GetCurrentTime();
-    mPtsDrift = pts - now;
-    mLastUpdateTime = now;
+    BeginWrite();
+    mPtsDrift.store(pts - now, RELAXED);
+    mLastUpdateTime.store(now, RELAXED);
+    EndWrite();
 }
 
 double MediaClock::GetClock() {
-    std::lock_guard<std::mutex> lock(mLock);
-    double now = GetCurrentTime();
-    if (bPause)
-        now = mLastUpdateTime;
-    return mPtsDrift + now - (now - mLastUpdateTime) * (1.0f - mSpeed);
+    uint32_t begin;
+    bool paused;
+    double speed, drift, lastUpdate;
+    do {
+        begin = mSequence.load(std::memory_order_acquire);
+        paused     = bPause.load(RELAXED);
+        speed      = mSpeed.load(RELAXED);
+        drift      = mPtsDrift.load(RELAXED);
+        lastUpdate = mLastUpdateTime.load(RELAXED);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((begin & 1) || begin != mSequence.load(RELAXED));
+
+    double now = paused ? lastUpdate : GetCurrentTime();
+    return drift + now - (now - lastUpdate) * (1.0f - speed);
 }
 
 void MediaClock::SetClockSerial(int serial) {
-    std::lock_guard<std::mutex> lck(mLock);
-    mSerial = serial;
+    std::lock_guard<std::mutex> lock(mWriteLock);
+    BeginWrite();
+    mSerial.store(serial, RELAXED);
+    EndWrite();
 }
 
 int MediaClock::GetClockSerial() {
-    std::lock_guard<std::mutex> lock(mLock);
-    return mSerial;
+    return mSerial.load(std::memory_order_acquire);
 }
 
 void MediaClock::SetSpeed(double speed) {
-    std::lock_guard<std::mutex> lock(mLock);
-    mSpeed = speed;
+    std::lock_guard<std::mutex> lock(mWriteLock);
+    BeginWrite();
+    mSpeed.store(speed, RELAXED);
+    EndWrite();
 }
 
 void MediaClock::SetPause(bool paused) {
-    std::lock_guard<std::mutex> lock(mLock);
-    bPause = paused;
+    std::lock_guard<std::mutex> lock(mWriteLock);
+    BeginWrite();
+    bPause.store(paused, RELAXED);
+    EndWrite();
+}
+
+void MediaClock::BeginWrite() {
+    // odd sequence: a write is in progress, readers retry
+    mSequence.store(mSequence.load(RELAXED) + 1, RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void MediaClock::EndWrite() {
+    mSequence.store(mSequence.load(RELAXED) + 1, std::memory_order_release);
 }
 
 double MediaClock::GetCurrentTime() {
-    return static_cast<double>(duration_cast<milliseconds >(
-            system_clock::now().time_since_epoch()).count()) / 1000.0;
+    return static_cast<double>(duration_cast<microseconds>(
+            steady_clock::now().time_since_epoch()).count()) / 1000000.0;
 }
@@ -1,6 +1,8 @@
 #ifndef MEDIA_CLOCK_H
 #define MEDIA_CLOCK_H
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 
 enum AVCLockType {
@@ -9,6 +11,7 @@ enum AVCLockType {
     CLOCK_EXTERNAL = 2
 };
 
+// writers are serialized by a mutex, readers go through a seqlock and never block
 class MediaClock {
 public:
     MediaClock();
@@ -26,15 +29,22 @@ public:
     void SetPause(bool paused);
 
 private:
+    // seconds of the monotonic clock, microsecond precision
     static double GetCurrentTime();
 
+    void BeginWrite();
+
+    void EndWrite();
+
 private:
-    std::mutex mLock;
-    int mSerial;
-    bool bPause;
-    double mSpeed;
-    double mPtsDrift;
-    double mLastUpdateTime;
+    std::mutex mWriteLock;
+    std::atomic<uint32_t> mSequence {0};
+
+    std::atomic<int> mSerial;
+    std::atomic_bool bPause;
+    std::atomic<double> mSpeed;
+    std::atomic<double> mPtsDrift;
+    std::atomic<double> mLastUpdateTime;
 
 };
 
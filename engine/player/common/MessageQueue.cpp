@@ -6,9 +6,12 @@
 
 #include "MessageQueue.h"
 
+#include <cstring>
+
 #include "CommonUtil.h"
 #include "NextErrorCode.h"
 #include "NextLog.h"
+#include "NextMessage.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,25 +25,14 @@ extern "C" {
 
 AVMessage::AVMessage(int what, int arg1, int arg2, void *obj, int len)
         : mWhat(what), mArg1(arg1), mArg2(arg2) {
-    mTime = CurrentTimeMs();
-    if (obj && len > 0) {
-        mObj = av_mallocz(len * sizeof(uint8_t));
-        if (mObj) {
-            memcpy(mObj, obj, len);
-        }
-    }
+    mTime = SteadyTimeMs();
+    SetObject(obj, len);
 }
 
 AVMessage::~AVMessage() {
     Clear();
 }
 
-int32_t MessageQueue::Start() {
-    std::lock_guard<std::mutex> lock(mMsgMutex);
-    mMsgAbort = false;
-    return RESULT_OK;
-}
-
 void AVMessage::Clear() {
     mWhat = 0;
     mArg1 = 0;
@@ -51,59 +43,84 @@ void AVMessage::Clear() {
     }
 }
 
-MessageQueue::MessageQueue() {
+void AVMessage::SetObject(void *obj, int len) {
+    if (mObj) {
+        av_freep(&mObj);
+    }
+    if (obj && len > 0) {
+        mObj = av_mallocz(len * sizeof(uint8_t));
+        if (mObj) {
+            memcpy(mObj, obj, len);
+        }
+    }
+}
+
+MessageQueue::MessageQueue(int poolSize) {
     mMsgAbort = false;
+    mPoolSize = poolSize > 0 ? poolSize : DEFAULT_MSG_POOL_SIZE;
+    for (int i = 0; i < mPoolSize; i++) {
+        mRecycledQueue.push(std::make_shared<AVMessage>());
+    }
+    // progress and buffering notifications only matter by their latest value
+    mCoalesceWhat = {MSG_BUFFER_UPDATE, MSG_BUFFER_BYTE_UPDATE, MSG_BUFFER_TIME_UPDATE};
 }
 
 MessageQueue::~MessageQueue() {
     mMsgAbort = false;
-    while (!mMessageQueue.empty()) {
-        mMessageQueue.pop();
-    }
+    mMessageQueue.clear();
+    mPendingCoalesce.clear();
     while (!mRecycledQueue.empty()) {
         mRecycledQueue.pop();
     }
 }
 
+int32_t MessageQueue::Start() {
+    std::lock_guard<std::mutex> lock(mMsgMutex);
+    mMsgAbort = false;
+    return RESULT_OK;
+}
+
 int32_t MessageQueue::Push(int what, int arg1, int arg2, void *obj, int len) {
+    return PushDelayed(0, what, arg1, arg2, obj, len);
+}
+
+int32_t MessageQueue::PushDelayed(int64_t delayMs, int what, int arg1, int arg2,
+                                  void *obj, int len) {
     std::lock_guard<std::mutex> lock(mMsgMutex);
-    sp<AVMessage> msg;
-    bool notify = false;
-    if (mRecycledQueue.empty()) {
-        try {
-            msg = std::make_shared<AVMessage>(what, arg1, arg2, obj, len);
-        } catch (const std::bad_alloc &e) {
-            NEXT_LOGE(MQ_TAG, "alloc message error: %s!\n", e.what());
-            return ERROR_OTHER_OOM;
-        } catch (...) {
-            NEXT_LOGE(MQ_TAG, "create message error!\n");
-            return ERROR_OTHER_OOM;
-        }
-    } else {
-        msg = mRecycledQueue.front();
-        mRecycledQueue.pop();
-        if (!msg) {
-            NEXT_LOGE(MQ_TAG, "pop message error!\n");
-            return ERROR_OTHER_OOM;
-        }
-        msg->mWhat = what;
+    int64_t time = SteadyTimeMs() + std::max(delayMs, (int64_t) 0);
+    mStat.push_count++;
+
+    auto pending = mPendingCoalesce.find(what);
+    if (pending != mPendingCoalesce.end()) {
+        sp<AVMessage> msg = pending->second;
         msg->mArg1 = arg1;
         msg->mArg2 = arg2;
-        msg->mTime = CurrentTimeMs();
-        if (obj && len > 0) {
-            msg->mObj = av_mallocz(len * sizeof(uint8_t));
-            if (msg->mObj) {
-                memcpy(msg->mObj, obj, len);
-            }
+        msg->SetObject(obj, len);
+        if (msg->mTime != time) {
+            EraseMessage(msg);
+            msg->mTime = time;
+            InsertMessage(msg);
+            mMsgCondition.notify_one();
         }
+        mStat.coalesce_count++;
+        return RESULT_OK;
     }
 
-    notify = mMessageQueue.empty();
-    mMessageQueue.push(msg);
+    sp<AVMessage> msg = ObtainMessage();
+    if (!msg) {
+        return ERROR_OTHER_OOM;
+    }
+    msg->mWhat = what;
+    msg->mArg1 = arg1;
+    msg->mArg2 = arg2;
+    msg->mTime = time;
+    msg->SetObject(obj, len);
 
-    if (notify) {
-        mMsgCondition.notify_one();
+    if (mCoalesceWhat.count(what)) {
+        mPendingCoalesce[what] = msg;
     }
+    InsertMessage(msg);
+    mMsgCondition.notify_one();
 
     return RESULT_OK;
 }
@@ -111,20 +128,35 @@ int32_t MessageQueue::Push(int what, int arg1, int arg2, void *obj, int len) {
 sp<AVMessage> MessageQueue::Pop(bool block) {
     std::unique_lock<std::mutex> lock(mMsgMutex);
     sp<AVMessage> ret;
-    while (mMessageQueue.empty()) {
-        if (!block || mMsgAbort) {
-            return ret;
-        } else {
+    while (!mMsgAbort) {
+        if (mMessageQueue.empty()) {
+            if (!block) {
+                return ret;
+            }
             mMsgCondition.wait(lock);
+            continue;
+        }
+        int64_t delay = mMessageQueue.front()->mTime - SteadyTimeMs();
+        if (delay <= 0) {
+            break;
         }
+        if (!block) {
+            return ret;
+        }
+        mMsgCondition.wait_for(lock, std::chrono::milliseconds(delay));
     }
     if (mMsgAbort) {
         return ret;
     }
     ret = mMessageQueue.front();
-    mMessageQueue.pop();
+    mMessageQueue.pop_front();
     if (!ret) {
         NEXT_LOGI(MQ_TAG, "pop null message!\n");
+        return ret;
+    }
+    auto pending = mPendingCoalesce.find(ret->mWhat);
+    if (pending != mPendingCoalesce.end() && pending->second == ret) {
+        mPendingCoalesce.erase(pending);
     }
     return ret;
 }
@@ -132,25 +164,24 @@ sp<AVMessage> MessageQueue::Pop(bool block) {
 int32_t MessageQueue::Flush() {
     std::lock_guard<std::mutex> lock(mMsgMutex);
     while (!mMessageQueue.empty()) {
-        auto msg = mMessageQueue.front();
-        msg->Clear();
-        mRecycledQueue.push(msg);
-        mMessageQueue.pop();
+        RecycleMessage(mMessageQueue.front());
+        mMessageQueue.pop_front();
     }
+    mPendingCoalesce.clear();
     return RESULT_OK;
 }
 
 int32_t MessageQueue::Remove(int what) {
     std::lock_guard<std::mutex> lock(mMsgMutex);
-    while (!mMessageQueue.empty()) {
-        auto msg = mMessageQueue.front();
-        if (msg && msg->mWhat == what) {
-            msg->Clear();
-            mRecycledQueue.push(msg);
-            mMessageQueue.pop();
-            break;
+    for (auto it = mMessageQueue.begin(); it != mMessageQueue.end();) {
+        if (*it && (*it)->mWhat == what) {
+            RecycleMessage(*it);
+            it = mMessageQueue.erase(it);
+        } else {
+            ++it;
         }
     }
+    mPendingCoalesce.erase(what);
     return RESULT_OK;
 }
 
@@ -159,8 +190,7 @@ int32_t MessageQueue::Recycle(sp<AVMessage> &msg) {
     if (!msg) {
         return RESULT_OK;
     }
-    msg->Clear();
-    mRecycledQueue.push(msg);
+    RecycleMessage(msg);
     return RESULT_OK;
 }
 
@@ -170,3 +200,67 @@ int32_t MessageQueue::Abort() {
     mMsgCondition.notify_one();
     return RESULT_OK;
 }
+
+void MessageQueue::SetCoalesce(int what, bool enable) {
+    std::lock_guard<std::mutex> lock(mMsgMutex);
+    if (enable) {
+        mCoalesceWhat.insert(what);
+    } else {
+        mCoalesceWhat.erase(what);
+        mPendingCoalesce.erase(what);
+    }
+}
+
+MessageQueueStat MessageQueue::GetStat() {
+    std::lock_guard<std::mutex> lock(mMsgMutex);
+    return mStat;
+}
+
+sp<AVMessage> MessageQueue::ObtainMessage() {
+    if (!mRecycledQueue.empty()) {
+        sp<AVMessage> msg = mRecycledQueue.front();
+        mRecycledQueue.pop();
+        if (!msg) {
+            NEXT_LOGE(MQ_TAG, "pop message error!\n");
+        }
+        return msg;
+    }
+    mStat.alloc_count++;
+    try {
+        return std::make_shared<AVMessage>();
+    } catch (const std::bad_alloc &e) {
+        NEXT_LOGE(MQ_TAG, "alloc message error: %s!\n", e.what());
+    } catch (...) {
+        NEXT_LOGE(MQ_TAG, "create message error!\n");
+    }
+    return nullptr;
+}
+
+void MessageQueue::InsertMessage(const sp<AVMessage> &msg) {
+    // keep push order for messages due at the same time
+    auto it = mMessageQueue.end();
+    while (it != mMessageQueue.begin() && (*(it - 1))->mTime > msg->mTime) {
+        --it;
+    }
+    mMessageQueue.insert(it, msg);
+}
+
+void MessageQueue::EraseMessage(const sp<AVMessage> &msg) {
+    for (auto it = mMessageQueue.begin(); it != mMessageQueue.end(); ++it) {
+        if (*it == msg) {
+            mMessageQueue.erase(it);
+            return;
+        }
+    }
+}
+
+void MessageQueue::RecycleMessage(const sp<AVMessage> &msg) {
+    if (!msg) {
+        return;
+    }
+    msg->Clear();
+    // the pool never grows past its preallocated size
+    if (static_cast<int>(mRecycledQueue.size()) < mPoolSize) {
+        mRecycledQueue.push(msg);
+    }
+}
@@ -5,8 +5,13 @@
 #include "NextStructDefine.h"
 
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <queue>
+#include <set>
+#include <unordered_map>
+
+#define DEFAULT_MSG_POOL_SIZE 64
 
 class AVMessage {
 public:
@@ -18,17 +23,25 @@ public:
 
     void Clear();
 
+    void SetObject(void *obj, int len);
+
 public:
     int mWhat     = 0;
     int mArg1     = 0;
     int mArg2     = 0;
     void *mObj    = nullptr;
-    int64_t mTime = 0;
+    int64_t mTime = 0; // delivery time of SteadyTimeMs
+};
+
+struct MessageQueueStat {
+    int64_t push_count     = 0;
+    int64_t coalesce_count = 0; // pushes merged into a pending message
+    int64_t alloc_count    = 0; // pool misses
 };
 
 class MessageQueue {
 public:
-    MessageQueue();
+    explicit MessageQueue(int poolSize = DEFAULT_MSG_POOL_SIZE);
 
     ~MessageQueue();
 
@@ -36,22 +49,46 @@ public:
 
     int32_t Push(int what, int arg1 = 0, int arg2 = 0, void *obj = nullptr, int len = 0);
 
+    // deliver no earlier than delayMs from now
+    int32_t PushDelayed(int64_t delayMs, int what, int arg1 = 0, int arg2 = 0,
+                        void *obj = nullptr, int len = 0);
+
+    // only returns messages whose delivery time is reached
     sp<AVMessage> Pop(bool block);
 
     int32_t Flush();
 
+    // remove every pending message of what
     int32_t Remove(int what);
 
     int32_t Recycle(sp<AVMessage> &msg);
 
     int32_t Abort();
 
+    // a pending message of what is replaced by the latest push instead of queued again
+    void SetCoalesce(int what, bool enable);
+
+    MessageQueueStat GetStat();
+
+private:
+    sp<AVMessage> ObtainMessage();
+
+    void InsertMessage(const sp<AVMessage> &msg);
+
+    void EraseMessage(const sp<AVMessage> &msg);
+
+    void RecycleMessage(const sp<AVMessage> &msg);
+
 private:
     bool mMsgAbort;
+    int mPoolSize;
     std::mutex mMsgMutex;
     std::condition_variable mMsgCondition;
-    std::queue<sp<AVMessage>> mMessageQueue;
+    std::deque<sp<AVMessage>> mMessageQueue; // ordered by mTime
     std::queue<sp<AVMessage>> mRecycledQueue;
+    std::set<int> mCoalesceWhat;
+    std::unordered_map<int, sp<AVMessage>> mPendingCoalesce;
+    MessageQueueStat mStat;
 };
 
 #endif
@@ -54,10 +54,17 @@ public:
                 }
                 case PIXEL_FORMAT_YUV420P:
                 case PIXEL_FORMAT_YUVJ420P:
-                case PIXEL_FORMAT_YUV420P10LE: {
+                case PIXEL_FORMAT_YUV420P10LE:
+                case PIXEL_FORMAT_YUV420SP:
+                case PIXEL_FORMAT_NV21:
+                case PIXEL_FORMAT_P010LE:
+                case PIXEL_FORMAT_YUV422P:
+                case PIXEL_FORMAT_YUV444P:
+                case PIXEL_FORMAT_YUV422P10LE:
+                case PIXEL_FORMAT_YUV444P10LE: {
+                    // the context goes back to the decoder's frame pool
                     auto *ctx = reinterpret_cast<FFmpegBufferContext *>(opaque);
                     ctx->release_frame(ctx);
-                    delete reinterpret_cast<FFmpegBufferContext *>(opaque);
                     break;
                 }
                 case PIXEL_FORMAT_HARMONY: {
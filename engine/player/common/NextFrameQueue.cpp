@@ -1,5 +1,5 @@
 /**
- * Note: frame queue: put、get、flush
+ * Note: frame queue: peek、push、next、flush
  * Date: 2026/4/13
  * Author: frank
  */
@@ -13,66 +13,140 @@
 #define TAG "FrameQueue"
 #define UNIQUE_LOCK std::unique_lock<std::mutex>
 
-FrameQueue::FrameQueue(int capacity)
-    : mCapacity(capacity) {}
+FrameQueue::FrameQueue() : FrameQueue(FRAME_QUEUE_SIZE) {}
 
-int FrameQueue::PutFrame(std::unique_ptr<FrameBuffer> &frame) {
+FrameQueue::FrameQueue(int capacity, bool keepLast)
+    : bKeepLast(keepLast),
+      mCapacity(capacity > 0 ? capacity : FRAME_QUEUE_SIZE) {
+    // all slots are allocated once and reused for the lifetime of the queue
+    mFrames.reset(new FrameBuffer[mCapacity]);
+    mSerials.reset(new int[mCapacity]());
+}
+
+FrameBuffer *FrameQueue::PeekWritable() {
+    UNIQUE_LOCK lock(mLock);
+    // woken by next, flush and abort
+    mCond.wait(lock, [this] {
+        return mSize < mCapacity || bAbort;
+    });
+    if (bAbort) {
+        return nullptr;
+    }
+    // a flush before Push makes the frame stale, its slot is never moved
+    mWriteSerial = mSerial;
+    return &mFrames[mWriteIndex];
+}
+
+void FrameQueue::Push() {
+    UNIQUE_LOCK lock(mLock);
+    mSerials[mWriteIndex] = mWriteSerial;
+    if (++mWriteIndex == mCapacity) {
+        mWriteIndex = 0;
+    }
+    mSize++;
+    mCond.notify_all();
+}
+
+FrameBuffer *FrameQueue::PeekReadable() {
+    UNIQUE_LOCK lock(mLock);
+    // woken by push, flush and abort
+    int serial = mSerial;
+    mCond.wait(lock, [&] {
+        DropStaleLocked();
+        return mSize - mReadIndexShown > 0 || bAbort || serial != mSerial;
+    });
+    if (bAbort || mSize - mReadIndexShown <= 0) {
+        return nullptr;
+    }
+    return &mFrames[(mReadIndex + mReadIndexShown) % mCapacity];
+}
+
+FrameBuffer *FrameQueue::Peek() {
+    UNIQUE_LOCK lock(mLock);
+    DropStaleLocked();
+    if (mSize - mReadIndexShown <= 0) {
+        return nullptr;
+    }
+    return &mFrames[(mReadIndex + mReadIndexShown) % mCapacity];
+}
+
+FrameBuffer *FrameQueue::PeekNext() {
     UNIQUE_LOCK lock(mLock);
-    int count = 0;
-    while (mCapacity > 0 && mFrameQueue.size() >= mCapacity) {
-        if (bAbort) {
-            return RESULT_OK;
-        }
-        if (mCond.wait_for(lock, std::chrono::milliseconds (QUEUE_WAIT_TIMEOUT))
-            == std::cv_status::timeout) {
-            if (count++ > 10) {
-                count = 0;
-                NEXT_LOGD(TAG, "full, wait for 1000ms timeout!\n");
-            }
-        }
+    DropStaleLocked();
+    if (mSize - mReadIndexShown <= 1) {
+        return nullptr;
     }
-    mFrameQueue.push(std::move(frame));
-    mCond.notify_one();
-    return RESULT_OK;
+    return &mFrames[(mReadIndex + mReadIndexShown + 1) % mCapacity];
 }
 
-int FrameQueue::GetFrame(std::unique_ptr<FrameBuffer> &frame) {
+FrameBuffer *FrameQueue::PeekLast() {
     UNIQUE_LOCK lock(mLock);
-    int count = 0;
-    while (mFrameQueue.empty()) {
-        if (bAbort) {
-            return RESULT_OK;
-        }
-        if (mCond.wait_for(lock, std::chrono::milliseconds (QUEUE_WAIT_TIMEOUT))
-            == std::cv_status::timeout) {
-            if (count++ > 10) {
-                count = 0;
-                NEXT_LOGD(TAG, "empty, wait for 1000ms timeout!\n");
-            }
-        }
+    if (mSize <= 0) {
+        return nullptr;
     }
-    frame = std::move(mFrameQueue.front());
-    mFrameQueue.pop();
-    mCond.notify_one();
-    return RESULT_OK;
+    return &mFrames[mReadIndex];
+}
+
+void FrameQueue::Next() {
+    UNIQUE_LOCK lock(mLock);
+    if (mSize <= 0) {
+        return;
+    }
+    // keep the shown frame around so PeekLast can still return it
+    if (bKeepLast && !mReadIndexShown) {
+        mReadIndexShown = 1;
+        return;
+    }
+    AdvanceLocked();
 }
 
 int FrameQueue::Size() {
     UNIQUE_LOCK lock(mLock);
-    return static_cast<int>(mFrameQueue.size());
+    DropStaleLocked();
+    return mSize - mReadIndexShown;
 }
 
 void FrameQueue::Flush() {
     UNIQUE_LOCK lock(mLock);
-    while (!mFrameQueue.empty()) {
-        mFrameQueue.pop();
+    mSerial++;
+    // the indexes only move forward: a slot between PeekWritable and Push
+    // stays with its producer, and the shown frame stays until replaced
+    if (!mReadIndexShown) {
+        DropStaleLocked();
     }
-    mCond.notify_one();
+    mCond.notify_all();
+}
+
+void FrameQueue::AdvanceLocked() {
+    mFrames[mReadIndex].Release();
+    if (++mReadIndex == mCapacity) {
+        mReadIndex = 0;
+    }
+    mSize--;
+    mCond.notify_all();
+}
+
+void FrameQueue::DropStaleLocked() {
+    // frames pushed before the last flush are never shown, as in ffplay the
+    // shown frame goes with them and the newest one dropped becomes the last
+    while (mSize - mReadIndexShown > 0 &&
+           mSerials[(mReadIndex + mReadIndexShown) % mCapacity] != mSerial) {
+        AdvanceLocked();
+    }
+}
+
+void FrameQueue::Start() {
+    UNIQUE_LOCK lock(mLock);
+    bAbort = false;
 }
 
 void FrameQueue::Abort() {
     UNIQUE_LOCK lock(mLock);
     bAbort = true;
-    mCapacity = 0;
-    mCond.notify_one();
+    mCond.notify_all();
+}
+
+int FrameQueue::GetSerial() {
+    UNIQUE_LOCK lock(mLock);
+    return mSerial;
 }
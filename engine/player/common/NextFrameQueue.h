@@ -2,36 +2,77 @@
 #define NEXT_FRAME_QUEUE_H
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
-#include <queue>
 
 #include "NextFrameBuffer.h"
 
+// fixed ring of reusable FrameBuffer slots, same model as ffplay's picture queue
 class FrameQueue {
 public:
-    FrameQueue() = default;
+    FrameQueue();
 
-    explicit FrameQueue(int capacity);
+    explicit FrameQueue(int capacity, bool keepLast = true);
 
     ~FrameQueue() = default;
 
-    int PutFrame(std::unique_ptr<FrameBuffer> &frame);
+    // block until a slot is free, nullptr when aborted
+    FrameBuffer *PeekWritable();
 
-    int GetFrame(std::unique_ptr<FrameBuffer> &frame);
+    // commit the slot returned by PeekWritable
+    void Push();
+
+    // block until a frame is readable, nullptr when aborted or flushed while waiting
+    FrameBuffer *PeekReadable();
+
+    // current frame, not removed from the queue
+    FrameBuffer *Peek();
+
+    // frame after the current one, for drop decisions
+    FrameBuffer *PeekNext();
+
+    // last shown frame when keepLast is set, otherwise the current one
+    FrameBuffer *PeekLast();
+
+    // release the current frame and advance
+    void Next();
 
     int Size();
 
+    // bump the serial and wake every waiter, frames pushed before are
+    // dropped unshown, now when nothing is on screen, else when peeked
     void Flush();
 
+    void Start();
+
+    // wake every waiter, which then returns nullptr
     void Abort();
 
+    int GetSerial();
+
+private:
+    // must hold mLock, release the frame at the read index
+    void AdvanceLocked();
+
+    // must hold mLock, drop the frames ahead of the reader from an old serial
+    void DropStaleLocked();
+
 private:
-    bool bAbort   = false;
-    int mCapacity = FRAME_QUEUE_SIZE;
+    bool bAbort         = false;
+    bool bKeepLast      = true;
+    int mCapacity       = FRAME_QUEUE_SIZE;
+    int mSize           = 0;
+    int mReadIndex      = 0;
+    int mWriteIndex     = 0;
+    int mReadIndexShown = 0;
+    int mSerial         = 0;
+    int mWriteSerial    = 0;
 
     std::mutex mLock;
     std::condition_variable mCond;
-    std::queue<std::unique_ptr<FrameBuffer>> mFrameQueue;
+    std::unique_ptr<FrameBuffer[]> mFrames;
+    // queue serial of each slot when it was handed to the producer
+    std::unique_ptr<int[]> mSerials;
 };
 
 #endif //NEXT_FRAME_QUEUE_H
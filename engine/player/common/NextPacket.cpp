@@ -12,8 +12,8 @@
 
 static bool IsIdrPacket(AVPacket *pkt, bool is_hevc) {
     if (pkt && pkt->data && pkt->size >= 5) {
-        uint32_t offset = 0;
-        while (offset >= 0 && offset + 5 <= pkt->size) {
+        int64_t offset = 0;
+        while (offset + 5 <= pkt->size) {
             auto *nal_start = reinterpret_cast<uint8_t *>(pkt->data + offset);
             if (is_hevc) {
                 int type = NALUnitParser::get_hevc_nal_unit_type((const uint8_t *const) nal_start);
@@ -26,15 +26,19 @@ static bool IsIdrPacket(AVPacket *pkt, bool is_hevc) {
                     return true;
                 }
             }
-            offset += (CommonUtil::byteToInt(nal_start) + 4);
+            offset += (ByteToInt(nal_start) + 4);
         }
     }
     return false;
 }
 
+NextPacket::NextPacket() {
+    mPkt = av_packet_alloc();
+}
+
 NextPacket::NextPacket(AVPacket *pkt) {
+    // av_packet_alloc already sets the defaults
     mPkt = av_packet_alloc();
-    av_init_packet(mPkt);
     av_packet_ref(mPkt, pkt);
 }
 
@@ -58,6 +62,18 @@ int NextPacket::GetSerial() const {
     return mSerial;
 }
 
+void NextPacket::SetSerial(int serial) {
+    mSerial = serial;
+}
+
+void NextPacket::Reset() {
+    if (mPkt) {
+        av_packet_unref(mPkt);
+    }
+    mSerial  = 0;
+    mPktType = PKT_OP_TYPE_DEFAULT;
+}
+
 bool NextPacket::IsKeyPacket() {
     return mPkt && mPkt->flags & AV_PKT_FLAG_KEY;
 }
@@ -17,6 +17,9 @@ enum PacketOpType {
 
 class NextPacket {
 public:
+    // empty packet shell, filled through GetPacket()
+    NextPacket();
+
     explicit NextPacket(AVPacket *pkt);
 
     NextPacket(AVPacket *pkt, int serial);
@@ -29,6 +32,11 @@ public:
 
     int GetSerial() const;
 
+    void SetSerial(int serial);
+
+    // unref the payload and keep the shell for reuse
+    void Reset();
+
     bool IsKeyPacket();
 
     bool IsFlushPacket();
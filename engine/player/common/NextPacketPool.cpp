@@ -0,0 +1,141 @@
+/**
+ * Note: recycle pool of NextPacket
+ * Date: 2026/10/18
+ */
+
+#include "NextPacketPool.h"
+
+#include "NextLog.h"
+
+#define TAG "PacketPool"
+
+#define LOCK_GUARD std::lock_guard<std::mutex>
+
+NextPacketPool::NextPacketPool(int maxSize)
+        : mMaxSize(maxSize > 0 ? maxSize : DEFAULT_PACKET_POOL_SIZE) {
+    mFreePackets.reserve(mMaxSize);
+}
+
+NextPacketPool::~NextPacketPool() {
+    NEXT_LOGD(TAG, "obtain=%lld, hit=%lld, drop=%lld, peak=%d, in_use=%d\n",
+              (long long) mStat.obtain_count, (long long) mStat.hit_count,
+              (long long) mStat.drop_count, mStat.peak_size, mStat.peak_in_use);
+    Clear();
+}
+
+std::unique_ptr<NextPacket> NextPacketPool::Obtain() {
+    std::unique_ptr<NextPacket> pkt;
+    {
+        LOCK_GUARD lock(mLock);
+        mStat.obtain_count++;
+        mInUse++;
+        mStat.peak_in_use = std::max(mStat.peak_in_use, mInUse);
+        if (!mFreePackets.empty()) {
+            pkt = std::move(mFreePackets.back());
+            mFreePackets.pop_back();
+            mStat.hit_count++;
+            return pkt;
+        }
+    }
+    pkt.reset(new NextPacket());
+    return pkt;
+}
+
+std::unique_ptr<NextPacket> NextPacketPool::Obtain(AVPacket *pkt, int serial) {
+    std::unique_ptr<NextPacket> packet = Obtain();
+    if (pkt) {
+        av_packet_ref(packet->GetPacket(), pkt);
+    }
+    packet->SetSerial(serial);
+    return packet;
+}
+
+void NextPacketPool::Recycle(std::unique_ptr<NextPacket> &pkt) {
+    if (!pkt) {
+        return;
+    }
+    // flush/eof packets carry no shell, just release them
+    bool reusable = pkt->GetPacket() != nullptr;
+    if (reusable) {
+        pkt->Reset();
+    }
+    LOCK_GUARD lock(mLock);
+    RecycleLocked(pkt, reusable);
+}
+
+void NextPacketPool::ObtainBatch(std::unique_ptr<NextPacket> *pkts, int count) {
+    int hit = 0;
+    {
+        LOCK_GUARD lock(mLock);
+        mStat.obtain_count += count;
+        mInUse += count;
+        mStat.peak_in_use = std::max(mStat.peak_in_use, mInUse);
+        while (hit < count && !mFreePackets.empty()) {
+            pkts[hit++] = std::move(mFreePackets.back());
+            mFreePackets.pop_back();
+        }
+        mStat.hit_count += hit;
+    }
+    for (int i = hit; i < count; i++) {
+        pkts[i].reset(new NextPacket());
+    }
+}
+
+void NextPacketPool::RecycleBatch(std::unique_ptr<NextPacket> *pkts, int count) {
+    // unref outside the lock, it may free payloads
+    for (int i = 0; i < count; i++) {
+        if (pkts[i] && pkts[i]->GetPacket()) {
+            pkts[i]->Reset();
+        }
+    }
+    LOCK_GUARD lock(mLock);
+    for (int i = 0; i < count; i++) {
+        if (pkts[i]) {
+            RecycleLocked(pkts[i], pkts[i]->GetPacket() != nullptr);
+        }
+    }
+}
+
+void NextPacketPool::RecycleLocked(std::unique_ptr<NextPacket> &pkt, bool reusable) {
+    mStat.recycle_count++;
+    mInUse = std::max(mInUse - 1, 0);
+    if (reusable && static_cast<int>(mFreePackets.size()) < mMaxSize) {
+        mFreePackets.push_back(std::move(pkt));
+        mStat.peak_size = std::max(mStat.peak_size, static_cast<int>(mFreePackets.size()));
+    } else {
+        mStat.drop_count++;
+        pkt.reset();
+    }
+}
+
+void NextPacketPool::Reserve(int count) {
+    LOCK_GUARD lock(mLock);
+    count = std::min(count, mMaxSize);
+    while (static_cast<int>(mFreePackets.size()) < count) {
+        mFreePackets.emplace_back(new NextPacket());
+    }
+    mStat.peak_size = std::max(mStat.peak_size, static_cast<int>(mFreePackets.size()));
+}
+
+void NextPacketPool::Clear() {
+    LOCK_GUARD lock(mLock);
+    mFreePackets.clear();
+}
+
+int NextPacketPool::Size() {
+    LOCK_GUARD lock(mLock);
+    return static_cast<int>(mFreePackets.size());
+}
+
+float NextPacketPool::HitRate() {
+    LOCK_GUARD lock(mLock);
+    if (mStat.obtain_count <= 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(mStat.hit_count) / static_cast<float>(mStat.obtain_count);
+}
+
+PacketPoolStat NextPacketPool::GetStat() {
+    LOCK_GUARD lock(mLock);
+    return mStat;
+}
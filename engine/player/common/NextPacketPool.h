@@ -0,0 +1,70 @@
+#ifndef NEXT_PACKET_POOL_H
+#define NEXT_PACKET_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "NextPacket.h"
+
+#define DEFAULT_PACKET_POOL_SIZE 512
+
+struct PacketPoolStat {
+    int64_t obtain_count  = 0;
+    int64_t hit_count     = 0;
+    int64_t recycle_count = 0;
+    int64_t drop_count    = 0; // recycled above the high-water mark
+    int peak_size         = 0; // max idle packets held
+    int peak_in_use       = 0; // max packets handed out at once
+};
+
+// recycle NextPacket with its AVPacket shell, shared by parser and decode threads
+class NextPacketPool {
+public:
+    explicit NextPacketPool(int maxSize = DEFAULT_PACKET_POOL_SIZE);
+
+    ~NextPacketPool();
+
+    // empty shell, fill it with GetPacket() (e.g. ReadPacket)
+    std::unique_ptr<NextPacket> Obtain();
+
+    // shell referencing pkt, like new NextPacket(pkt, serial)
+    std::unique_ptr<NextPacket> Obtain(AVPacket *pkt, int serial);
+
+    void Recycle(std::unique_ptr<NextPacket> &pkt);
+
+    // fill pkts[0, count) with empty shells under one lock
+    void ObtainBatch(std::unique_ptr<NextPacket> *pkts, int count);
+
+    // recycle every non-null pkts[i] under one lock
+    void RecycleBatch(std::unique_ptr<NextPacket> *pkts, int count);
+
+    // allocate shells up front, bounded by the high-water mark
+    void Reserve(int count);
+
+    void Clear();
+
+    int Size();
+
+    float HitRate();
+
+    PacketPoolStat GetStat();
+
+    NextPacketPool(const NextPacketPool &) = delete;
+
+    NextPacketPool &operator=(const NextPacketPool &) = delete;
+
+private:
+    // must hold mLock
+    void RecycleLocked(std::unique_ptr<NextPacket> &pkt, bool reusable);
+
+private:
+    int mMaxSize = DEFAULT_PACKET_POOL_SIZE;
+    int mInUse   = 0;
+
+    std::mutex mLock;
+    PacketPoolStat mStat;
+    std::vector<std::unique_ptr<NextPacket>> mFreePackets;
+};
+
+#endif //NEXT_PACKET_POOL_H
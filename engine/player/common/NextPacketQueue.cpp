@@ -14,44 +14,189 @@
 
 #define UNIQUE_LOCK std::unique_lock<std::mutex>
 
+static inline int64_t PacketBytes(const std::unique_ptr<NextPacket> &pkt) {
+    AVPacket *packet = pkt ? pkt->GetPacket() : nullptr;
+    return packet ? packet->size : 0;
+}
+
+static inline int64_t PacketDuration(const std::unique_ptr<NextPacket> &pkt) {
+    AVPacket *packet = pkt ? pkt->GetPacket() : nullptr;
+    return packet ? std::max(packet->duration, (int64_t) MIN_PKT_DURATION) : 0;
+}
+
+static inline void AtomicAdd(std::atomic<int64_t> &counter, int64_t value) {
+    // single writer, so a relaxed load + store is enough and avoids a locked RMW
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
 NextPacketQueue::NextPacketQueue(int type) {
     mDuration  = 0;
     mByteCount = 0;
 }
 
+NextPacketQueue::NextPacketQueue(int type, PacketQueueMode mode, int capacity)
+        : NextPacketQueue(type) {
+    mMode = mode;
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        uint64_t size = 2;
+        while (size < static_cast<uint64_t>(capacity)) {
+            size <<= 1;
+        }
+        mRingMask = size - 1;
+        mRing.resize(size);
+    }
+}
+
+PacketQueueMode NextPacketQueue::GetMode() const {
+    return mMode;
+}
+
 int NextPacketQueue::PutPacket(std::unique_ptr<NextPacket> &pkt) {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        return PutRingPacket(pkt);
+    }
     UNIQUE_LOCK lock(mLock);
-    AVPacket *packet = pkt ? pkt->GetPacket() : nullptr;
-    mByteCount += packet ? packet->size : 0;
-    mDuration  += packet ? std::max(packet->duration, (int64_t) MIN_PKT_DURATION) : 0;
-    mPktQueue.push(std::move(pkt));
+    PushPacket(pkt);
+    bool high = CheckHighWaterMark();
+    lock.unlock();
+    if (high) {
+        NotifyWaterMark(WATER_MARK_HIGH);
+    }
+    return RESULT_OK;
+}
+
+int NextPacketQueue::PutPackets(std::unique_ptr<NextPacket> *pkts, int count) {
+    int put = 0;
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        while (put < count && PushRingPacket(pkts[put])) {
+            put++;
+        }
+        if (put > 0 && bConsumerWaiting.load()) {
+            UNIQUE_LOCK lock(mLock);
+            mCond.notify_one();
+        }
+        if (put > 0 && CheckHighWaterMark()) {
+            NotifyWaterMark(WATER_MARK_HIGH);
+        }
+        return put;
+    }
+    UNIQUE_LOCK lock(mLock);
+    for (; put < count; put++) {
+        mByteCount += PacketBytes(pkts[put]);
+        mDuration  += PacketDuration(pkts[put]);
+        mPktQueue.push(std::move(pkts[put]));
+    }
+    bool high = CheckHighWaterMark();
     mCond.notify_one();
+    lock.unlock();
+    if (high) {
+        NotifyWaterMark(WATER_MARK_HIGH);
+    }
+    return put;
+}
+
+int NextPacketQueue::TryPutPacket(std::unique_ptr<NextPacket> &pkt) {
+    if (bAbort) {
+        return ERROR_PLAYER_ABORT;
+    }
+    if (!IsControlPacket(pkt) && IsFull()) {
+        return ERROR_PLAYER_TRY_AGAIN;
+    }
+    return PutPacket(pkt);
+}
+
+int NextPacketQueue::PutPacket(std::unique_ptr<NextPacket> &pkt, int timeoutMs) {
+    // flush/eof packets must never be held back
+    if (IsControlPacket(pkt)) {
+        return PutPacket(pkt);
+    }
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(std::max(timeoutMs, 0));
+    UNIQUE_LOCK lock(mLock);
+    // published before the counters are read: a SPSC get in between either
+    // is seen by IsFullLocked or sees the flag and notifies under the lock
+    bProducerWaiting.store(true);
+    while (!bAbort && IsFullLocked()) {
+        // woken by get, flush and abort
+        if (timeoutMs < 0) {
+            mPutCond.wait(lock);
+        } else if (mPutCond.wait_until(lock, deadline) == std::cv_status::timeout &&
+                   IsFullLocked() && !bAbort) {
+            bProducerWaiting.store(false);
+            return ERROR_PLAYER_TRY_AGAIN;
+        }
+    }
+    bProducerWaiting.store(false);
+    if (bAbort) {
+        return ERROR_PLAYER_ABORT;
+    }
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        lock.unlock();
+        return PutRingPacket(pkt);
+    }
+    PushPacket(pkt);
+    bool high = CheckHighWaterMark();
+    lock.unlock();
+    if (high) {
+        NotifyWaterMark(WATER_MARK_HIGH);
+    }
     return RESULT_OK;
 }
 
+void NextPacketQueue::PushPacket(std::unique_ptr<NextPacket> &pkt) {
+    mByteCount += PacketBytes(pkt);
+    mDuration  += PacketDuration(pkt);
+    mPktQueue.push(std::move(pkt));
+    mCond.notify_one();
+}
+
 int NextPacketQueue::GetPacket(std::unique_ptr<NextPacket> &pkt, bool block) {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        return GetRingPacket(pkt, block);
+    }
     UNIQUE_LOCK lock(mLock);
+    if (bAbort) {
+        return ERROR_PLAYER_ABORT;
+    }
     if (mPktQueue.empty() && !block)
         return ERROR_PLAYER_TRY_AGAIN;
-    int count = 0;
-    while (mPktQueue.empty() && block) {
-        if (mCond.wait_for(lock, std::chrono::milliseconds (QUEUE_WAIT_TIMEOUT))
-            == std::cv_status::timeout) {
-            if (count++ > 10) {
-                count = 0;
-                NEXT_LOGD(TAG, "empty, wait for 1000ms timeout!\n");
-            }
-        }
+    // woken by put, flush and abort
+    int serial = mSerial.load();
+    mCond.wait(lock, [&] {
+        return !mPktQueue.empty() || bAbort || serial != mSerial.load();
+    });
+    if (bAbort) {
+        return ERROR_PLAYER_ABORT;
+    }
+    if (mPktQueue.empty()) {
+        // flushed while waiting, let the caller pick up the new serial
+        return ERROR_PLAYER_TRY_AGAIN;
     }
     pkt = std::move(mPktQueue.front());
-    AVPacket *packet = pkt ? pkt->GetPacket() : nullptr;
-    mByteCount -= packet ? packet->size : 0;
-    mDuration  -= packet ? std::max(packet->duration, (int64_t) MIN_PKT_DURATION) : 0;
+    mByteCount -= PacketBytes(pkt);
+    mDuration  -= PacketDuration(pkt);
     mPktQueue.pop();
+    bool low = CheckLowWaterMark();
+    if (bProducerWaiting) {
+        mPutCond.notify_one();
+    }
+    lock.unlock();
+    if (low) {
+        NotifyWaterMark(WATER_MARK_LOW);
+    }
     return RESULT_OK;
 }
 
 bool NextPacketQueue::IsFlushPacket() {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        DropFlushedPackets();
+        uint64_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        auto &front = mRing[head & mRingMask];
+        return front && front->IsFlushPacket();
+    }
     UNIQUE_LOCK lock(mLock);
     if (mPktQueue.empty()) {
         return false;
@@ -63,21 +208,50 @@ bool NextPacketQueue::IsFlushPacket() {
 }
 
 int NextPacketQueue::PacketCount() {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        int packets;
+        int64_t bytes, duration;
+        GetCount(&packets, &bytes, &duration);
+        return packets;
+    }
     UNIQUE_LOCK lock(mLock);
     return static_cast<int>(mPktQueue.size());
 }
 
 int64_t NextPacketQueue::ByteCount() {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        return AdjustCount(mPutBytes.load(), mGetBytes.load(), mFlushBytes.load());
+    }
     UNIQUE_LOCK lock(mLock);
     return mByteCount;
 }
 
 int64_t NextPacketQueue::Duration() {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        return AdjustCount(mPutDuration.load(), mGetDuration.load(), mFlushDuration.load());
+    }
     UNIQUE_LOCK lock(mLock);
     return mDuration;
 }
 
 void NextPacketQueue::Flush() {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        // everything below the flush index is dropped by the consumer, except flush packets
+        mFlushPackets.store(mPutPackets.load(std::memory_order_relaxed));
+        mFlushBytes.store(mPutBytes.load(std::memory_order_relaxed));
+        mFlushDuration.store(mPutDuration.load(std::memory_order_relaxed));
+        mFlushIndex.store(mTail.load(std::memory_order_relaxed), std::memory_order_release);
+        {
+            UNIQUE_LOCK lock(mLock);
+            mSerial++;
+            mCond.notify_all();
+            mPutCond.notify_one();
+        }
+        if (CheckLowWaterMark()) {
+            NotifyWaterMark(WATER_MARK_LOW);
+        }
+        return;
+    }
     UNIQUE_LOCK lock(mLock);
     int flushCount = 0;
     while (!mPktQueue.empty()) {
@@ -94,9 +268,30 @@ void NextPacketQueue::Flush() {
 
     mDuration  = 0;
     mByteCount = 0;
+    mSerial++;
+    bool low = CheckLowWaterMark();
+    mCond.notify_all();
+    mPutCond.notify_one();
+    lock.unlock();
+    if (low) {
+        NotifyWaterMark(WATER_MARK_LOW);
+    }
 }
 
 void NextPacketQueue::Release() {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        uint64_t tail = mTail.load(std::memory_order_acquire);
+        for (uint64_t i = mHead.load(std::memory_order_relaxed); i < tail; ++i) {
+            mRing[i & mRingMask].reset();
+        }
+        mGetPackets.store(mPutPackets.load());
+        mGetBytes.store(mPutBytes.load());
+        mGetDuration.store(mPutDuration.load());
+        mGetFlushMarks.store(mPutFlushMarks.load());
+        mFlushIndex.store(tail);
+        mHead.store(tail, std::memory_order_release);
+        return;
+    }
     UNIQUE_LOCK lock(mLock);
     while (!mPktQueue.empty()) {
         mPktQueue.pop();
@@ -104,3 +299,243 @@ void NextPacketQueue::Release() {
     mDuration  = 0;
     mByteCount = 0;
 }
+
+void NextPacketQueue::Start() {
+    UNIQUE_LOCK lock(mLock);
+    bAbort = false;
+}
+
+void NextPacketQueue::Abort() {
+    UNIQUE_LOCK lock(mLock);
+    bAbort = true;
+    mCond.notify_all();
+    mPutCond.notify_all();
+}
+
+int NextPacketQueue::GetSerial() {
+    return mSerial.load(std::memory_order_acquire);
+}
+
+void NextPacketQueue::SetWaterMark(const PacketQueueWaterMark &mark) {
+    UNIQUE_LOCK lock(mLock);
+    mHighPackets  = mark.high_packets;
+    mHighBytes    = mark.high_bytes;
+    mHighDuration = mark.high_duration;
+    mLowPackets   = mark.low_packets > 0 ? mark.low_packets : mark.high_packets / 2;
+    mLowBytes     = mark.low_bytes > 0 ? mark.low_bytes : mark.high_bytes / 2;
+    mLowDuration  = mark.low_duration > 0 ? mark.low_duration : mark.high_duration / 2;
+    bWaterMarkEnable = mark.high_packets > 0 ||
+                       mark.high_bytes > 0 ||
+                       mark.high_duration > 0;
+    bHighWater = false;
+}
+
+void NextPacketQueue::SetWaterMarkCallback(WaterMarkCallback callback) {
+    UNIQUE_LOCK lock(mLock);
+    mWaterMarkCb = std::move(callback);
+}
+
+bool NextPacketQueue::IsFull() {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        return IsFullLocked();
+    }
+    UNIQUE_LOCK lock(mLock);
+    return IsFullLocked();
+}
+
+bool NextPacketQueue::IsFullLocked() {
+    if (mMode == PKT_QUEUE_MODE_SPSC &&
+        mTail.load() - mHead.load() > mRingMask) {
+        return true;
+    }
+    if (!bWaterMarkEnable) {
+        return false;
+    }
+    int packets;
+    int64_t bytes, duration;
+    GetCount(&packets, &bytes, &duration);
+    return ReachHighWaterMark(packets, bytes, duration);
+}
+
+// locked mode: must hold mLock
+void NextPacketQueue::GetCount(int *packets, int64_t *bytes, int64_t *duration) {
+    if (mMode == PKT_QUEUE_MODE_SPSC) {
+        int64_t count = AdjustCount(mPutPackets.load(), mGetPackets.load(), mFlushPackets.load());
+        count += std::max(mPutFlushMarks.load() - mGetFlushMarks.load(), (int64_t) 0);
+        *packets  = static_cast<int>(count);
+        *bytes    = AdjustCount(mPutBytes.load(), mGetBytes.load(), mFlushBytes.load());
+        *duration = AdjustCount(mPutDuration.load(), mGetDuration.load(), mFlushDuration.load());
+    } else {
+        *packets  = static_cast<int>(mPktQueue.size());
+        *bytes    = mByteCount;
+        *duration = mDuration;
+    }
+}
+
+bool NextPacketQueue::ReachHighWaterMark(int packets, int64_t bytes, int64_t duration) const {
+    int highPackets      = mHighPackets.load(std::memory_order_relaxed);
+    int64_t highBytes    = mHighBytes.load(std::memory_order_relaxed);
+    int64_t highDuration = mHighDuration.load(std::memory_order_relaxed);
+    return (highPackets > 0 && packets >= highPackets) ||
+           (highBytes > 0 && bytes >= highBytes) ||
+           (highDuration > 0 && duration >= highDuration);
+}
+
+bool NextPacketQueue::BelowLowWaterMark(int packets, int64_t bytes, int64_t duration) const {
+    return (mHighPackets.load(std::memory_order_relaxed) <= 0 ||
+            packets <= mLowPackets.load(std::memory_order_relaxed)) &&
+           (mHighBytes.load(std::memory_order_relaxed) <= 0 ||
+            bytes <= mLowBytes.load(std::memory_order_relaxed)) &&
+           (mHighDuration.load(std::memory_order_relaxed) <= 0 ||
+            duration <= mLowDuration.load(std::memory_order_relaxed));
+}
+
+// returns true on the transition to high, locked mode: must hold mLock
+bool NextPacketQueue::CheckHighWaterMark() {
+    if (!bWaterMarkEnable || bHighWater.load()) {
+        return false;
+    }
+    int packets;
+    int64_t bytes, duration;
+    GetCount(&packets, &bytes, &duration);
+    return ReachHighWaterMark(packets, bytes, duration) && !bHighWater.exchange(true);
+}
+
+// returns true on the transition back to low, locked mode: must hold mLock
+bool NextPacketQueue::CheckLowWaterMark() {
+    if (!bWaterMarkEnable || !bHighWater.load()) {
+        return false;
+    }
+    int packets;
+    int64_t bytes, duration;
+    GetCount(&packets, &bytes, &duration);
+    return BelowLowWaterMark(packets, bytes, duration) && bHighWater.exchange(false);
+}
+
+void NextPacketQueue::NotifyWaterMark(int state) {
+    // called without the lock held, the callback may call back into the queue
+    WaterMarkCallback callback;
+    {
+        UNIQUE_LOCK lock(mLock);
+        callback = mWaterMarkCb;
+    }
+    if (callback) {
+        callback(state);
+    }
+}
+
+bool NextPacketQueue::IsControlPacket(const std::unique_ptr<NextPacket> &pkt) {
+    return pkt && (pkt->IsFlushPacket() || pkt->IsEofPacket());
+}
+
+int NextPacketQueue::PutRingPacket(std::unique_ptr<NextPacket> &pkt) {
+    if (!PushRingPacket(pkt)) {
+        return ERROR_PLAYER_TRY_AGAIN;
+    }
+    // only pay for the lock when the consumer is parked
+    if (bConsumerWaiting.load()) {
+        UNIQUE_LOCK lock(mLock);
+        mCond.notify_one();
+    }
+    if (CheckHighWaterMark()) {
+        NotifyWaterMark(WATER_MARK_HIGH);
+    }
+    return RESULT_OK;
+}
+
+bool NextPacketQueue::PushRingPacket(std::unique_ptr<NextPacket> &pkt) {
+    uint64_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mHead.load(std::memory_order_acquire) > mRingMask) {
+        return false;
+    }
+    if (pkt && pkt->IsFlushPacket()) {
+        AtomicAdd(mPutFlushMarks, 1);
+    } else {
+        AtomicAdd(mPutPackets, 1);
+        AtomicAdd(mPutBytes, PacketBytes(pkt));
+        AtomicAdd(mPutDuration, PacketDuration(pkt));
+    }
+    mRing[tail & mRingMask] = std::move(pkt);
+    mTail.store(tail + 1);
+    return true;
+}
+
+int NextPacketQueue::GetRingPacket(std::unique_ptr<NextPacket> &pkt, bool block) {
+    // no lock unless the consumer has to park
+    int serial = mSerial.load(std::memory_order_acquire);
+    uint64_t head;
+    while (true) {
+        if (bAbort) {
+            return ERROR_PLAYER_ABORT;
+        }
+        DropFlushedPackets();
+        head = mHead.load(std::memory_order_relaxed);
+        if (head != mTail.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (!block) {
+            return ERROR_PLAYER_TRY_AGAIN;
+        }
+        // the producer reads the flag after publishing mTail, so no wakeup is lost
+        UNIQUE_LOCK lock(mLock);
+        bConsumerWaiting.store(true);
+        mCond.wait(lock, [&] {
+            return head != mTail.load() || bAbort || serial != mSerial.load();
+        });
+        bConsumerWaiting.store(false);
+        if (serial != mSerial.load() && head == mTail.load() && !bAbort) {
+            return ERROR_PLAYER_TRY_AGAIN;
+        }
+    }
+    TakeRingPacket(pkt, head);
+    WakeProducer();
+    if (CheckLowWaterMark()) {
+        NotifyWaterMark(WATER_MARK_LOW);
+    }
+    return RESULT_OK;
+}
+
+void NextPacketQueue::DropFlushedPackets() {
+    uint64_t flushIndex = mFlushIndex.load(std::memory_order_acquire);
+    uint64_t head = mHead.load(std::memory_order_relaxed);
+    bool dropped = false;
+    while (head < flushIndex) {
+        auto &front = mRing[head & mRingMask];
+        if (front && front->IsFlushPacket()) {
+            break;
+        }
+        std::unique_ptr<NextPacket> pkt;
+        TakeRingPacket(pkt, head);
+        head++;
+        dropped = true;
+    }
+    // the slots freed here may be all a parked producer waits for
+    if (dropped) {
+        WakeProducer();
+    }
+}
+
+void NextPacketQueue::WakeProducer() {
+    // pairs with the producer publishing bProducerWaiting before checking the counters
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (bProducerWaiting.load()) {
+        UNIQUE_LOCK lock(mLock);
+        mPutCond.notify_one();
+    }
+}
+
+void NextPacketQueue::TakeRingPacket(std::unique_ptr<NextPacket> &pkt, uint64_t head) {
+    pkt = std::move(mRing[head & mRingMask]);
+    if (pkt && pkt->IsFlushPacket()) {
+        AtomicAdd(mGetFlushMarks, 1);
+    } else {
+        AtomicAdd(mGetPackets, 1);
+        AtomicAdd(mGetBytes, PacketBytes(pkt));
+        AtomicAdd(mGetDuration, PacketDuration(pkt));
+    }
+    mHead.store(head + 1, std::memory_order_release);
+}
+
+int64_t NextPacketQueue::AdjustCount(int64_t put, int64_t get, int64_t flushed) {
+    return std::max(put - std::max(get, flushed), (int64_t) 0);
+}
@@ -1,13 +1,39 @@
 #ifndef NEXT_PACKET_QUEUE_H
 #define NEXT_PACKET_QUEUE_H
 
+#include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include "NextPacket.h"
 
 #define MIN_PKT_DURATION 16
+#define DEFAULT_RING_CAPACITY 1024
+
+enum PacketQueueMode {
+    PKT_QUEUE_MODE_LOCKED = 0, // mutex + std::queue, any number of threads
+    PKT_QUEUE_MODE_SPSC   = 1  // bounded lock-free ring, one producer and one consumer
+};
+
+enum WaterMarkState {
+    WATER_MARK_HIGH = 1, // a high limit is reached, stop reading
+    WATER_MARK_LOW  = 2  // drained below every low limit, resume reading
+};
+
+// 0 means unlimited for high marks, half of the high mark for low marks
+struct PacketQueueWaterMark {
+    int high_packets      = 0;
+    int64_t high_bytes    = 0;
+    int64_t high_duration = 0; // same unit as Duration()
+    int low_packets       = 0;
+    int64_t low_bytes     = 0;
+    int64_t low_duration  = 0;
+};
+
+using WaterMarkCallback = std::function<void(int)>;
 
 class NextPacketQueue {
 public:
@@ -15,12 +41,28 @@ public:
 
     explicit NextPacketQueue(int type);
 
+    NextPacketQueue(int type, PacketQueueMode mode, int capacity = DEFAULT_RING_CAPACITY);
+
     ~NextPacketQueue() = default;
 
+    // SPSC: producer side, returns ERROR_PLAYER_TRY_AGAIN and keeps pkt when the ring is full
     int PutPacket(std::unique_ptr<NextPacket> &pkt);
 
+    // put pkts[0, count) with one lock and one wakeup, returns the number queued;
+    // SPSC: stops when the ring is full, the rest stays in pkts
+    int PutPackets(std::unique_ptr<NextPacket> *pkts, int count);
+
+    // like PutPacket, but returns ERROR_PLAYER_TRY_AGAIN once a high water mark is reached
+    int TryPutPacket(std::unique_ptr<NextPacket> &pkt);
+
+    // wait until below the high water mark, timeoutMs < 0 waits until Abort()
+    int PutPacket(std::unique_ptr<NextPacket> &pkt, int timeoutMs);
+
+    // SPSC: consumer side, a blocked call returns ERROR_PLAYER_ABORT on Abort()
+    // and ERROR_PLAYER_TRY_AGAIN when flushed while still empty
     int GetPacket(std::unique_ptr<NextPacket> &pkt, bool block);
 
+    // SPSC: consumer side
     bool IsFlushPacket();
 
     int PacketCount();
@@ -29,17 +71,113 @@ public:
 
     int64_t Duration();
 
+    // SPSC: producer side, flushed packets are dropped lazily by the consumer
     void Flush();
 
+    // SPSC: the consumer must not be running
     void Release();
 
+    void Start();
+
+    // wake every blocked put/get, which then returns ERROR_PLAYER_ABORT
+    void Abort();
+
+    // bumped by every Flush()
+    int GetSerial();
+
+    void SetWaterMark(const PacketQueueWaterMark &mark);
+
+    // invoked outside the queue lock with WATER_MARK_HIGH / WATER_MARK_LOW
+    void SetWaterMarkCallback(WaterMarkCallback callback);
+
+    bool IsFull();
+
+    PacketQueueMode GetMode() const;
+
+private:
+    void PushPacket(std::unique_ptr<NextPacket> &pkt);
+
+    int PutRingPacket(std::unique_ptr<NextPacket> &pkt);
+
+    // SPSC: no wakeup or water mark check, done once by the caller
+    bool PushRingPacket(std::unique_ptr<NextPacket> &pkt);
+
+    void GetCount(int *packets, int64_t *bytes, int64_t *duration);
+
+    bool ReachHighWaterMark(int packets, int64_t bytes, int64_t duration) const;
+
+    bool BelowLowWaterMark(int packets, int64_t bytes, int64_t duration) const;
+
+    bool IsFullLocked();
+
+    bool CheckHighWaterMark();
+
+    bool CheckLowWaterMark();
+
+    void NotifyWaterMark(int state);
+
+    static bool IsControlPacket(const std::unique_ptr<NextPacket> &pkt);
+
+    int GetRingPacket(std::unique_ptr<NextPacket> &pkt, bool block);
+
+    void DropFlushedPackets();
+
+    void TakeRingPacket(std::unique_ptr<NextPacket> &pkt, uint64_t head);
+
+    // SPSC consumer: notify a producer parked in PutPacket(pkt, timeoutMs)
+    void WakeProducer();
+
+    static int64_t AdjustCount(int64_t put, int64_t get, int64_t flushed);
+
 private:
+    PacketQueueMode mMode = PKT_QUEUE_MODE_LOCKED;
+
+    // bumped under mLock, read lock-free by the SPSC consumer
+    std::atomic<int> mSerial {0};
+
     int64_t mDuration  = 0;
     int64_t mByteCount = 0;
 
     std::mutex mLock;
     std::condition_variable mCond;
+    std::condition_variable mPutCond;
     std::queue<std::unique_ptr<NextPacket>> mPktQueue;
+
+    // read by the SPSC sides without the lock, a mark set while running
+    // may be seen half applied for one check
+    std::atomic_bool bWaterMarkEnable {false};
+    std::atomic<int> mHighPackets {0};
+    std::atomic<int64_t> mHighBytes {0};
+    std::atomic<int64_t> mHighDuration {0};
+    std::atomic<int> mLowPackets {0};
+    std::atomic<int64_t> mLowBytes {0};
+    std::atomic<int64_t> mLowDuration {0};
+    // set under mLock, copied under it before each call
+    WaterMarkCallback mWaterMarkCb;
+    std::atomic_bool bAbort {false};
+    std::atomic_bool bHighWater {false};
+    std::atomic_bool bProducerWaiting {false};
+
+    // SPSC ring, indexes grow monotonically and are masked on access
+    uint64_t mRingMask = 0;
+    std::vector<std::unique_ptr<NextPacket>> mRing;
+    alignas(64) std::atomic<uint64_t> mHead {0};
+    alignas(64) std::atomic<uint64_t> mTail {0};
+    std::atomic<uint64_t> mFlushIndex {0};
+    std::atomic_bool bConsumerWaiting {false};
+
+    // cumulative counters: written by one side only, flush markers counted apart
+    alignas(64) std::atomic<int64_t> mPutPackets {0};
+    std::atomic<int64_t> mPutBytes {0};
+    std::atomic<int64_t> mPutDuration {0};
+    std::atomic<int64_t> mPutFlushMarks {0};
+    alignas(64) std::atomic<int64_t> mGetPackets {0};
+    std::atomic<int64_t> mGetBytes {0};
+    std::atomic<int64_t> mGetDuration {0};
+    std::atomic<int64_t> mGetFlushMarks {0};
+    alignas(64) std::atomic<int64_t> mFlushPackets {0};
+    std::atomic<int64_t> mFlushBytes {0};
+    std::atomic<int64_t> mFlushDuration {0};
 };
 
 
@@ -7,8 +7,10 @@
 #ifndef NEXTPLAYER_DEFINE_H
 #define NEXTPLAYER_DEFINE_H
 
+#include "AVSyncController.h"
 #include "MediaClock.h"
 #include "NextSpeedMeter.h"
+#include "NextStructDefine.h"
 
 // thread name
 #define THREAD_MEDIA_PARSER "MediaParser"
@@ -33,13 +35,6 @@
 #define AUDIO_CACHE_64K  (64 * 1024)
 #define VIDEO_CACHE_256K (256 * 1024)
 
-// render rate
-#define REFRESH_RATE 0.01
-#define MAX_FRAME_DURATION 10.0
-#define FRAME_DROP_THRESHOLD 0.15
-#define AV_SYNC_THRESHOLD_MIN 0.04
-#define AV_SYNC_THRESHOLD_MAX 0.1
-
 enum PlayerState {
     MP_STATE_IDLE = 0,
     MP_STATE_INITIALIZED,
@@ -91,6 +86,15 @@ typedef struct AVStatistic {
     AVCacheStatistic video_cache;
     AVCacheStatistic audio_cache;
 
+    AVSyncStatistic sync_stat;
+    AdaptiveStatistic adaptive_stat;
+
+    RollingSnapshot decode_fps_stat;
+    RollingSnapshot render_fps_stat;
+    RollingSnapshot net_speed_stat;
+
+    VideoSpeedMeter decode_speed_meter;
+    VideoSpeedMeter render_speed_meter;
     NetworkSpeedMeter net_speed_meter;
 
 } AVStatistic;
@@ -109,7 +113,7 @@ struct PlayerLink {
 
     int error_code              = 0;
     int loop_count              = 0;
-    int skip_frame              = 0;
+    int skip_frame              = 0; // AVDiscard, VideoDecoderOption::skip_frame
     int nal_length_size         = 0;
     int drop_aframe_count       = 0;
     int drop_vframe_count       = 0;
@@ -144,11 +148,26 @@ struct PlayerLink {
     std::unique_ptr<NextMediaClock> audio_clock;
     std::unique_ptr<NextMediaClock> video_clock;
     std::unique_ptr<NextMediaClock> external_clock;
+    std::unique_ptr<AVSyncController> sync_controller;
     std::condition_variable video_accurate_seek_cond;
     std::condition_variable audio_accurate_seek_cond;
 
 };
 
+static inline void updateSpeedStatistic(AVStatistic &stat) {
+    stat.decode_fps_stat = stat.decode_speed_meter.getStatistics();
+    stat.render_fps_stat = stat.render_speed_meter.getStatistics();
+    stat.net_speed_stat  = stat.net_speed_meter.getStatistics();
+}
+
+static inline void updateCacheStatistic(AVStatistic &stat, const IOCacheStatistic &io) {
+    stat.cache_file_pos  = io.file_pos;
+    stat.real_cache_size = io.cache_size;
+    if (io.file_size > 0) {
+        stat.real_file_size = io.file_size;
+    }
+}
+
 static inline int getMasterSyncType(std::shared_ptr<PlayerLink> &pLink) {
     if (!pLink) {
         return CLOCK_EXTERNAL;
@@ -16,10 +16,18 @@ void VideoSpeedMeter::reset() {
     mNextIndex  = 0;
     mFirstIndex = 0;
     memset(mSamples, 0, sizeof(mSamples));
+    mFpsStat.Reset();
 }
 
 float VideoSpeedMeter::add() {
-    int64_t now = CurrentTimeMs();
+    // in us, frames of 120fps and up are less than 10ms apart
+    int64_t now = SteadyTimeUs();
+    if (mCount > 0) {
+        int64_t last = mSamples[(mNextIndex + mSampleSize - 1) % mSampleSize];
+        if (now > last) {
+            mFpsStat.Add(1000000.0 / static_cast<double>(now - last), now / 1000);
+        }
+    }
     mSamples[mNextIndex] = now;
     mNextIndex++;
     mNextIndex %= mSampleSize;
@@ -34,15 +42,22 @@ float VideoSpeedMeter::add() {
         return 0.0f;
     }
 
-    return 1000.0f * static_cast<float>((mCount - 1) / (now - mSamples[mFirstIndex]));
+    return 1000000.0f * static_cast<float>(mCount - 1) /
+           static_cast<float>(now - mSamples[mFirstIndex]);
+}
+
+RollingSnapshot VideoSpeedMeter::getStatistics() {
+    return mFpsStat.Snapshot();
 }
 
 void NetworkSpeedMeter::reset(int sampleRange) {
     mSampleRange        = sampleRange;
-    mLastSampleTick     = CurrentTimeMs();
+    mLastSampleTick     = SteadyTimeMs();
     mLastSampleSize     = 0;
     mLastSampleSpeed    = 0;
     mLastSampleDuration = 0;
+    mLastStatTick       = 0;
+    mSpeedStat.Reset();
 }
 
 int64_t NetworkSpeedMeter::add(int size) {
@@ -53,7 +68,7 @@ int64_t NetworkSpeedMeter::add(int size) {
     int64_t sampleSize   = mLastSampleSize;
     int64_t sampleRange  = mSampleRange;
     int64_t lastDuration = mLastSampleDuration;
-    int64_t now = CurrentTimeMs();
+    int64_t now = SteadyTimeMs();
     int64_t elapsed = std::abs(now - lastTick);
 
     if ((elapsed < 0 || elapsed >= sampleRange) && sampleRange > 0) {
@@ -61,6 +76,8 @@ int64_t NetworkSpeedMeter::add(int size) {
         mLastSampleSize     = size;
         mLastSampleSpeed    = size * 1000 / sampleRange;
         mLastSampleDuration = sampleRange;
+        mLastStatTick       = now;
+        mSpeedStat.Add(static_cast<double>(mLastSampleSpeed), now);
         return mLastSampleSpeed;
     }
 
@@ -76,6 +93,10 @@ int64_t NetworkSpeedMeter::add(int size) {
     mLastSampleSize = currentSize;
     if (curDuration > 0) {
         mLastSampleSpeed = currentSize * 1000 / curDuration;
+        if (now - mLastStatTick >= NETWORK_STAT_BUCKET_MS) {
+            mLastStatTick = now;
+            mSpeedStat.Add(static_cast<double>(mLastSampleSpeed), now);
+        }
     }
 
     return mLastSampleSpeed;
@@ -86,7 +107,7 @@ int64_t NetworkSpeedMeter::getSpeed() const {
     int64_t lastTick     = mLastSampleTick;
     int64_t sampleRange  = mSampleRange;
     int64_t lastDuration = mLastSampleDuration;
-    int64_t now          = CurrentTimeMs();
+    int64_t now          = SteadyTimeMs();
     int64_t elapsed      = std::abs(now - lastTick);
 
     if (elapsed < 0 || elapsed >= sampleRange)
@@ -108,3 +129,7 @@ int64_t NetworkSpeedMeter::getSpeed() const {
 int64_t NetworkSpeedMeter::getLastSpeed() const {
     return mLastSampleSpeed;
 }
+
+RollingSnapshot NetworkSpeedMeter::getStatistics() {
+    return mSpeedStat.Snapshot();
+}
@@ -3,7 +3,11 @@
 
 #include <cstdint>
 
+#include "RollingStatistics.h"
+
 #define DEFAULT_SAMPLE_SIZE 10
+// one throughput sample per bucket, add() may come once per packet
+#define NETWORK_STAT_BUCKET_MS 100
 
 // decode and render rate
 class VideoSpeedMeter {
@@ -14,14 +18,19 @@ public:
 
     void reset();
 
+    // average fps over the last samples
     float add();
 
+    // instantaneous fps: ewma, percentiles and min/max of the window
+    RollingSnapshot getStatistics();
+
 private:
     int mCount      = 0;
     int mNextIndex  = 0;
     int mFirstIndex = 0;
     int mSampleSize = DEFAULT_SAMPLE_SIZE;
-    int64_t mSamples[DEFAULT_SAMPLE_SIZE] = {0};
+    int64_t mSamples[DEFAULT_SAMPLE_SIZE] = {0}; // us
+    RollingStatistics mFpsStat;
 };
 
 // transfer speed
@@ -39,12 +48,17 @@ public:
 
     int64_t getLastSpeed() const;
 
+    // throughput in bytes/s: ewma, percentiles and min/max of the window
+    RollingSnapshot getStatistics();
+
 private:
     int64_t mSampleRange        = 0;
     int64_t mLastSampleTick     = 0;
     int64_t mLastSampleSize     = 0;
     int64_t mLastSampleSpeed    = 0;
     int64_t mLastSampleDuration = 0;
+    int64_t mLastStatTick       = 0;
+    RollingStatistics mSpeedStat;
 };
 
 #endif // NEXT_SPEED_METER_H
@@ -0,0 +1,157 @@
+/**
+ * Note: rolling statistics: ewma、percentile、min/max
+ * Date: 2026/10/18
+ */
+
+#include "RollingStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CommonUtil.h"
+
+#define LOCK_GUARD std::lock_guard<std::mutex>
+
+RollingStatistics::RollingStatistics(int64_t windowMs, double alpha, int capacity)
+        : mWindowMs(windowMs),
+          mAlpha(alpha) {
+    if (capacity <= 0) {
+        capacity = static_cast<int>(std::max<int64_t>(windowMs * DEFAULT_STAT_RATE / 1000, 16));
+    }
+    mSamples.resize(std::min(capacity, MAX_STAT_CAPACITY));
+    mSorted.reserve(capacity);
+}
+
+RollingStatistics::RollingStatistics(const RollingStatistics &stat) {
+    *this = stat;
+}
+
+RollingStatistics &RollingStatistics::operator=(const RollingStatistics &stat) {
+    if (this != &stat) {
+        std::lock(mLock, stat.mLock);
+        LOCK_GUARD lock(mLock, std::adopt_lock);
+        LOCK_GUARD other(stat.mLock, std::adopt_lock);
+        mWindowMs = stat.mWindowMs;
+        mAlpha    = stat.mAlpha;
+        mEwma     = stat.mEwma;
+        bHasEwma  = stat.bHasEwma;
+        mHead     = stat.mHead;
+        mCount    = stat.mCount;
+        mSamples  = stat.mSamples;
+        mSorted.reserve(mSamples.size());
+    }
+    return *this;
+}
+
+void RollingStatistics::Reset() {
+    LOCK_GUARD lock(mLock);
+    mEwma    = 0.0;
+    bHasEwma = false;
+    mHead    = 0;
+    mCount   = 0;
+}
+
+void RollingStatistics::Add(double value) {
+    Add(value, SteadyTimeMs());
+}
+
+void RollingStatistics::Add(double value, int64_t timeMs) {
+    if (std::isnan(value) || std::isinf(value)) {
+        return;
+    }
+    LOCK_GUARD lock(mLock);
+    mEwma = bHasEwma ? mAlpha * value + (1.0 - mAlpha) * mEwma : value;
+    bHasEwma = true;
+
+    Expire(timeMs);
+    if (mCount == static_cast<int>(mSamples.size())) {
+        Grow();
+    }
+    int capacity = static_cast<int>(mSamples.size());
+    if (mCount == capacity) {
+        // at the cap: drop the oldest
+        mHead = (mHead + 1) % capacity;
+        mCount--;
+    }
+    mSamples[(mHead + mCount) % capacity] = {timeMs, value};
+    mCount++;
+}
+
+double RollingStatistics::Ewma() {
+    LOCK_GUARD lock(mLock);
+    return mEwma;
+}
+
+double RollingStatistics::Percentile(double p) {
+    LOCK_GUARD lock(mLock);
+    Expire(SteadyTimeMs());
+    return PercentileLocked(p);
+}
+
+double RollingStatistics::Min() {
+    return Percentile(0);
+}
+
+double RollingStatistics::Max() {
+    return Percentile(100);
+}
+
+int RollingStatistics::Count() {
+    LOCK_GUARD lock(mLock);
+    Expire(SteadyTimeMs());
+    return mCount;
+}
+
+RollingSnapshot RollingStatistics::Snapshot() {
+    LOCK_GUARD lock(mLock);
+    Expire(SteadyTimeMs());
+    RollingSnapshot snapshot;
+    snapshot.ewma  = static_cast<float>(mEwma);
+    snapshot.count = mCount;
+    if (mCount > 0) {
+        // PercentileLocked leaves mSorted sorted, reuse it for the rest
+        snapshot.p50 = static_cast<float>(PercentileLocked(50));
+        snapshot.p95 = static_cast<float>(mSorted[static_cast<int>(std::ceil(0.95 * mCount)) - 1]);
+        snapshot.p99 = static_cast<float>(mSorted[static_cast<int>(std::ceil(0.99 * mCount)) - 1]);
+        snapshot.min = static_cast<float>(mSorted.front());
+        snapshot.max = static_cast<float>(mSorted.back());
+    }
+    return snapshot;
+}
+
+void RollingStatistics::Expire(int64_t now) {
+    int capacity = static_cast<int>(mSamples.size());
+    while (mCount > 0 && now - mSamples[mHead].time > mWindowMs) {
+        mHead = (mHead + 1) % capacity;
+        mCount--;
+    }
+}
+
+void RollingStatistics::Grow() {
+    int capacity = static_cast<int>(mSamples.size());
+    if (capacity >= MAX_STAT_CAPACITY) {
+        return;
+    }
+    std::vector<Sample> samples(std::min(capacity * 2, MAX_STAT_CAPACITY));
+    for (int i = 0; i < mCount; i++) {
+        samples[i] = mSamples[(mHead + i) % capacity];
+    }
+    mSamples.swap(samples);
+    mHead = 0;
+    mSorted.reserve(mSamples.size());
+}
+
+double RollingStatistics::PercentileLocked(double p) {
+    if (mCount <= 0) {
+        return 0.0;
+    }
+    int capacity = static_cast<int>(mSamples.size());
+    mSorted.clear();
+    for (int i = 0; i < mCount; i++) {
+        mSorted.push_back(mSamples[(mHead + i) % capacity].value);
+    }
+    std::sort(mSorted.begin(), mSorted.end());
+    p = std::min(std::max(p, 0.0), 100.0);
+    int rank = static_cast<int>(std::ceil(p / 100.0 * mCount));
+    return mSorted[std::max(rank - 1, 0)];
+}
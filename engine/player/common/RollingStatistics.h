@@ -0,0 +1,84 @@
+#ifndef ROLLING_STATISTICS_H
+#define ROLLING_STATISTICS_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#define DEFAULT_STAT_WINDOW_MS 5000
+// samples per second the window is first sized for, it grows with the real rate
+#define DEFAULT_STAT_RATE      120
+#define MAX_STAT_CAPACITY      8192
+#define DEFAULT_EWMA_ALPHA     0.1
+
+typedef struct RollingSnapshot {
+    float ewma = 0.0;
+    float p50  = 0.0;
+    float p95  = 0.0;
+    float p99  = 0.0;
+    float min  = 0.0;
+    float max  = 0.0;
+    int count  = 0;
+} RollingSnapshot;
+
+// EWMA over all samples, percentiles and min/max over a time window.
+// The ring doubles while the window holds more samples than it fits,
+// past MAX_STAT_CAPACITY the oldest samples of the window are dropped.
+class RollingStatistics {
+public:
+    // capacity 0: windowMs * DEFAULT_STAT_RATE / 1000
+    explicit RollingStatistics(int64_t windowMs = DEFAULT_STAT_WINDOW_MS,
+                               double alpha = DEFAULT_EWMA_ALPHA,
+                               int capacity = 0);
+
+    ~RollingStatistics() = default;
+
+    void Reset();
+
+    void Add(double value);
+
+    void Add(double value, int64_t timeMs);
+
+    double Ewma();
+
+    // p in [0, 100], nearest rank
+    double Percentile(double p);
+
+    double Min();
+
+    double Max();
+
+    int Count();
+
+    RollingSnapshot Snapshot();
+
+    RollingStatistics(const RollingStatistics &stat);
+
+    RollingStatistics &operator=(const RollingStatistics &stat);
+
+private:
+    struct Sample {
+        int64_t time;
+        double value;
+    };
+
+    void Expire(int64_t now);
+
+    void Grow();
+
+    double PercentileLocked(double p);
+
+private:
+    mutable std::mutex mLock;
+    int64_t mWindowMs = DEFAULT_STAT_WINDOW_MS;
+    double mAlpha     = DEFAULT_EWMA_ALPHA;
+    double mEwma  = 0.0;
+    bool bHasEwma = false;
+
+    int mHead  = 0; // oldest sample
+    int mCount = 0;
+    std::vector<Sample> mSamples;
+    std::vector<double> mSorted;
+};
+
+#endif // ROLLING_STATISTICS_H
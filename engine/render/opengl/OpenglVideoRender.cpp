@@ -348,80 +348,6 @@ int OpenGLVideoRender::SetInputFrame(VideoFrameMetaData *inputFrameMetaData) {
                          GL_UNSIGNED_BYTE, inputFrameMetaData->pitches[0]);
             glBindTexture(GL_TEXTURE_2D, 0);
             break;
-        case PIXEL_FORMAT_YUV420P:
-            if (nullptr == inputFrameMetaData->pitches[0] ||
-                nullptr == inputFrameMetaData->pitches[1] ||
-                nullptr == inputFrameMetaData->pitches[2]) {
-                NEXT_LOGE(OPENGL_RENDER, "inputFrameMetaData->pitches is nullptr\n");
-                return ERROR_RENDER_INPUT;
-            }
-
-            if (-1 == mTextures[0] ||
-                mRenderMetaData.frame_width != inputFrameMetaData->frame_width ||
-                mRenderMetaData.frame_height != inputFrameMetaData->frame_height ||
-                mRenderMetaData.linesize[0] != inputFrameMetaData->linesize[0] ||
-                mRenderMetaData.linesize[1] != inputFrameMetaData->linesize[1] ||
-                mRenderMetaData.linesize[2] != inputFrameMetaData->linesize[2]) {
-                UpdateInputFrameData(inputFrameMetaData);
-                if (mTextures[0] != -1) {
-                    glDeleteTextures(1, &mTextures[0]);
-                    glDeleteTextures(1, &mTextures[1]);
-                    glDeleteTextures(1, &mTextures[2]);
-                }
-                mTextures[0] = CreateTexture();
-                mTextures[1] = CreateTexture();
-                mTextures[2] = CreateTexture();
-            }
-
-            glBindTexture(GL_TEXTURE_2D, mTextures[0]);
-            glTexImage2D(
-                    GL_TEXTURE_2D, 0, GL_LUMINANCE, inputFrameMetaData->linesize[0],
-                    inputFrameMetaData->frame_height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    inputFrameMetaData->pitches[0]);
-            glBindTexture(GL_TEXTURE_2D, mTextures[1]);
-            glTexImage2D(
-                    GL_TEXTURE_2D, 0, GL_LUMINANCE, inputFrameMetaData->linesize[1],
-                    inputFrameMetaData->frame_height / 2, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    inputFrameMetaData->pitches[1]);
-            glBindTexture(GL_TEXTURE_2D, mTextures[2]);
-            glTexImage2D(
-                    GL_TEXTURE_2D, 0, GL_LUMINANCE, inputFrameMetaData->linesize[2],
-                    inputFrameMetaData->frame_height / 2, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    inputFrameMetaData->pitches[2]);
-            break;
-        case PIXEL_FORMAT_YUV420SP:
-            if (nullptr == inputFrameMetaData->pitches[0] ||
-                nullptr == inputFrameMetaData->pitches[1]) {
-                NEXT_LOGE(OPENGL_RENDER, "inputFrameMetaData->pitches is nullptr\n");
-                return ERROR_RENDER_INPUT;
-            }
-            if (mTextures[0] == -1 ||
-                mRenderMetaData.frame_width != inputFrameMetaData->frame_width ||
-                mRenderMetaData.frame_height != inputFrameMetaData->frame_height ||
-                mRenderMetaData.linesize[0] != inputFrameMetaData->linesize[0] ||
-                mRenderMetaData.linesize[1] != inputFrameMetaData->linesize[1]) {
-                UpdateInputFrameData(inputFrameMetaData);
-                if (mTextures[0] != -1) {
-                    glDeleteTextures(1, &mTextures[0]);
-                    glDeleteTextures(1, &mTextures[1]);
-                }
-                mTextures[0] = CreateTexture();
-                mTextures[1] = CreateTexture();
-            }
-
-            glBindTexture(GL_TEXTURE_2D, mTextures[0]);
-            glTexImage2D(
-                    GL_TEXTURE_2D, 0, GL_LUMINANCE, inputFrameMetaData->linesize[0],
-                    inputFrameMetaData->frame_height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    inputFrameMetaData->pitches[0]);
-            glBindTexture(GL_TEXTURE_2D, mTextures[1]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA,
-                         inputFrameMetaData->linesize[1] / 2,
-                         inputFrameMetaData->frame_height / 2, 0,
-                         GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,
-                         inputFrameMetaData->pitches[1]);
-            glBindTexture(GL_TEXTURE_2D, 0);
-            break;
         case PIXEL_FORMAT_VIDEOTOOLBOX: {
 #if defined(__APPLE__)
             if (nullptr == inputFrameMetaData->pixel_buffer) {
@@ -509,50 +435,14 @@ int OpenGLVideoRender::SetInputFrame(VideoFrameMetaData *inputFrameMetaData) {
 #endif
         }
             break;
-        case PIXEL_FORMAT_YUV420P10LE:
-            if (nullptr == inputFrameMetaData->pitches[0] ||
-                nullptr == inputFrameMetaData->pitches[1] ||
-                nullptr == inputFrameMetaData->pitches[2]) {
-                NEXT_LOGE(OPENGL_RENDER, "inputFrameMetaData->pitches is nullptr\n");
-                return ERROR_RENDER_INPUT;
-            }
-
-            if (mTextures[0] == -1 ||
-                mRenderMetaData.frame_width != inputFrameMetaData->frame_width ||
-                mRenderMetaData.frame_height != inputFrameMetaData->frame_height ||
-                mRenderMetaData.linesize[0] != inputFrameMetaData->linesize[0] ||
-                mRenderMetaData.linesize[1] != inputFrameMetaData->linesize[1] ||
-                mRenderMetaData.linesize[2] != inputFrameMetaData->linesize[2]) {
-                UpdateInputFrameData(inputFrameMetaData);
-                if (mTextures[0] != -1) {
-                    glDeleteTextures(1, &mTextures[0]);
-                    glDeleteTextures(1, &mTextures[1]);
-                    glDeleteTextures(1, &mTextures[2]);
-                }
-                mTextures[0] = CreateTexture();
-                mTextures[1] = CreateTexture();
-                mTextures[2] = CreateTexture();
-            }
-
-            glBindTexture(GL_TEXTURE_2D, mTextures[0]);
-            glTexImage2D(
-                    GL_TEXTURE_2D, 0, GL_LUMINANCE, inputFrameMetaData->linesize[0] / 2,
-                    inputFrameMetaData->frame_height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    inputFrameMetaData->pitches[0]);
-            glBindTexture(GL_TEXTURE_2D, mTextures[1]);
-            glTexImage2D(
-                    GL_TEXTURE_2D, 0, GL_LUMINANCE, inputFrameMetaData->linesize[1] / 2,
-                    inputFrameMetaData->frame_height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    inputFrameMetaData->pitches[1]);
-            glBindTexture(GL_TEXTURE_2D, mTextures[2]);
-            glTexImage2D(
-                    GL_TEXTURE_2D, 0, GL_LUMINANCE, inputFrameMetaData->linesize[2] / 2,
-                    inputFrameMetaData->frame_height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    inputFrameMetaData->pitches[2]);
-            break;
         case PIXEL_FORMAT_MEDIACODEC:
             break;
-        default:
+        default: {
+            int ret = UploadPlanes(inputFrameMetaData);
+            if (ret != RESULT_OK) {
+                return ret;
+            }
+        }
             break;
     }
 
@@ -577,6 +467,51 @@ int OpenGLVideoRender::SetInputFrame(VideoFrameMetaData *inputFrameMetaData) {
     return RESULT_OK;
 }
 
+int OpenGLVideoRender::UploadPlanes(VideoFrameMetaData *inputFrameMetaData) {
+    PlaneTexture planes[MAX_PLANE_TEXTURES];
+    int count = GetPlaneTextures(inputFrameMetaData->pixel_format, planes);
+    if (count == 0) {
+        return RESULT_OK;
+    }
+    bool changed = mTextures[0] == -1 ||
+                   mRenderMetaData.pixel_format != inputFrameMetaData->pixel_format ||
+                   mRenderMetaData.frame_width != inputFrameMetaData->frame_width ||
+                   mRenderMetaData.frame_height != inputFrameMetaData->frame_height;
+    for (int i = 0; i < count; i++) {
+        if (nullptr == inputFrameMetaData->pitches[i]) {
+            NEXT_LOGE(OPENGL_RENDER, "inputFrameMetaData->pitches is nullptr\n");
+            return ERROR_RENDER_INPUT;
+        }
+        changed |= mRenderMetaData.linesize[i] != inputFrameMetaData->linesize[i];
+    }
+
+    if (changed) {
+        UpdateInputFrameData(inputFrameMetaData);
+        // only the planes of the last layout hold names, a stale one may belong to a live texture
+        for (int i = 0; i < MAX_PLANE_TEXTURES; i++) {
+            if (mTextures[i] != -1 && mTextures[i] != 0) {
+                glDeleteTextures(1, &mTextures[i]);
+            }
+            mTextures[i] = -1;
+        }
+        for (int i = 0; i < count; i++) {
+            mTextures[i] = CreateTexture();
+        }
+    }
+
+    // planes go up as decoded, the shader does the conversion
+    for (int i = 0; i < count; i++) {
+        int shift  = planes[i].height_shift;
+        int height = (inputFrameMetaData->frame_height + (1 << shift) - 1) >> shift;
+        glBindTexture(GL_TEXTURE_2D, mTextures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, planes[i].format,
+                     inputFrameMetaData->linesize[i] / planes[i].texel_bytes, height, 0,
+                     planes[i].format, GL_UNSIGNED_BYTE, inputFrameMetaData->pitches[i]);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return RESULT_OK;
+}
+
 int OpenGLVideoRender::OnScreenRender() {
     if (nullptr == mOpenglFilter) {
         NEXT_LOGE(OPENGL_RENDER, "openglFilterDevice is nullptr\n");
@@ -593,22 +528,20 @@ int OpenGLVideoRender::OnScreenRender() {
         case PIXEL_FORMAT_RGBA8888:
             mOpenglFilter->SetInputTexture(mTextures[0], 0);
             break;
-        case PIXEL_FORMAT_YUV420P:
-        case PIXEL_FORMAT_YUV420SP:
-            for (int i = 0; i < 3; i++) {
-                mOpenglFilter->SetInputTexture(mTextures[i], i);
-            }
-            break;
         case PIXEL_FORMAT_VIDEOTOOLBOX:
             for (int i = 0; i < 2; i++) {
                 mOpenglFilter->SetInputTexture(mTextures[i], i);
             }
             break;
-        case PIXEL_FORMAT_YUV420P10LE:
-            break;
         case PIXEL_FORMAT_MEDIACODEC:
             break;
-        default:
+        default: {
+            PlaneTexture planes[MAX_PLANE_TEXTURES];
+            int count = GetPlaneTextures(mInputFrameData->pixel_format, planes);
+            for (int i = 0; i < count; i++) {
+                mOpenglFilter->SetInputTexture(mTextures[i], i);
+            }
+        }
             break;
     }
 
@@ -62,6 +62,9 @@ private:
 
     void UpdateInputFrameData(VideoFrameMetaData *inputFrameMetaData);
 
+    // textures of the yuv formats, one per plane
+    int UploadPlanes(VideoFrameMetaData *inputFrameMetaData);
+
 private:
 
 #if defined(__APPLE__)
@@ -10,6 +10,47 @@
 
 #define OPENGL_TAG "OpenGLUtil"
 
+int GetPlaneTextures(VideoPixelFormat format, PlaneTexture planes[MAX_PLANE_TEXTURES]) {
+    // 16 bit samples go in as luminance (low byte) and alpha (high byte)
+    switch (format) {
+        case PIXEL_FORMAT_YUV420P:
+        case PIXEL_FORMAT_YUVJ420P:
+            planes[0] = {GL_LUMINANCE, 1, 0};
+            planes[1] = {GL_LUMINANCE, 1, 1};
+            planes[2] = {GL_LUMINANCE, 1, 1};
+            return 3;
+        case PIXEL_FORMAT_YUV422P:
+        case PIXEL_FORMAT_YUV444P:
+            planes[0] = {GL_LUMINANCE, 1, 0};
+            planes[1] = {GL_LUMINANCE, 1, 0};
+            planes[2] = {GL_LUMINANCE, 1, 0};
+            return 3;
+        case PIXEL_FORMAT_YUV420P10LE:
+            planes[0] = {GL_LUMINANCE_ALPHA, 2, 0};
+            planes[1] = {GL_LUMINANCE_ALPHA, 2, 1};
+            planes[2] = {GL_LUMINANCE_ALPHA, 2, 1};
+            return 3;
+        case PIXEL_FORMAT_YUV422P10LE:
+        case PIXEL_FORMAT_YUV444P10LE:
+            planes[0] = {GL_LUMINANCE_ALPHA, 2, 0};
+            planes[1] = {GL_LUMINANCE_ALPHA, 2, 0};
+            planes[2] = {GL_LUMINANCE_ALPHA, 2, 0};
+            return 3;
+        case PIXEL_FORMAT_YUV420SP:
+        case PIXEL_FORMAT_NV21:
+            planes[0] = {GL_LUMINANCE, 1, 0};
+            planes[1] = {GL_LUMINANCE_ALPHA, 2, 1};
+            return 2;
+        case PIXEL_FORMAT_P010LE:
+            // uv pairs of 16 bit samples fill the rgba of one texel
+            planes[0] = {GL_LUMINANCE_ALPHA, 2, 0};
+            planes[1] = {GL_RGBA, 4, 1};
+            return 2;
+        default:
+            return 0;
+    }
+}
+
 GLuint CreateProgram(const std::string &vertexShader, const std::string &fragmentShader) {
     if (vertexShader.empty()) {
         NEXT_LOGE(OPENGL_TAG, "vertex shader is empty!\n");
@@ -12,6 +12,20 @@
 #import <OpenGLES/ES2/glext.h>
 #endif
 
+#include "NextDefine.h"
+
+#define MAX_PLANE_TEXTURES 3
+
+// one plane uploaded as it is, width in texels is linesize / texel_bytes
+struct PlaneTexture {
+    GLenum format;
+    int texel_bytes;
+    int height_shift; // chroma subsampling
+};
+
+// textures of the yuv formats, 0 for formats not uploaded plane by plane
+int GetPlaneTextures(VideoPixelFormat format, PlaneTexture planes[MAX_PLANE_TEXTURES]);
+
 GLuint CreateProgram(const std::string &vertexShader, const std::string &fragmentShader);
 
 GLuint CreateTexture();
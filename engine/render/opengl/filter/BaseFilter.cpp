@@ -124,8 +124,14 @@ void BaseFilter::UpdateParam() {
         mInputFrameData->frame_height = height;
     }
 
-    if (mInputFrameData->linesize[0] > mInputFrameData->frame_width) {
-        mPaddingPixels = mInputFrameData->linesize[0] - mInputFrameData->frame_width;
+    // linesize is in bytes, 10 bit samples take two
+    PlaneTexture planes[MAX_PLANE_TEXTURES];
+    int rowBytes = mInputFrameData->frame_width;
+    if (GetPlaneTextures(mInputFrameData->pixel_format, planes) > 0) {
+        rowBytes *= planes[0].texel_bytes;
+    }
+    if (mInputFrameData->linesize[0] > rowBytes) {
+        mPaddingPixels = mInputFrameData->linesize[0] - rowBytes;
     }
 
 //    bool onlyTexture = false;
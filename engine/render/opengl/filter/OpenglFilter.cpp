@@ -7,6 +7,7 @@
 
 #include "./OpenglFilter.h"
 
+#include "../common/OpenGLUtil.h"
 #include "NextErrorCode.h"
 #include "NextLog.h"
 
@@ -40,7 +41,7 @@ int OpenGLFilter::init(VideoFrameMetaData *inputFrameMetaData,
     std::string error{};
     mGLContext = context;
     mInputFrameData = inputFrameMetaData;
-    mFixelFormat = inputFrameMetaData->pixel_format;
+    mPixelFormat = inputFrameMetaData->pixel_format;
     switch (mInputFrameData->pixel_format) {
         case PIXEL_FORMAT_RGB565:
         case PIXEL_FORMAT_RGB888:
@@ -50,20 +51,33 @@ int OpenGLFilter::init(VideoFrameMetaData *inputFrameMetaData,
             }
         }
             break;
-        case PIXEL_FORMAT_YUV420P: {
+        case PIXEL_FORMAT_YUV420P:
+        case PIXEL_FORMAT_YUVJ420P:
+        case PIXEL_FORMAT_YUV422P:
+        case PIXEL_FORMAT_YUV444P: {
+            // subsampling only changes the chroma texture size
             std::string shader = GetYUV420p2RGBFragmentShader(mInputFrameData->color_range == AVCOL_RANGE_JPEG);
             if (!InitWithFragmentShader(shader, 3)) {
-                error = "init yuv420p shader error!";
+                error = "init yuv planar shader error!";
             }
         }
             break;
-        case PIXEL_FORMAT_YUV420SP: {
-            std::string shader = GetYUV420sp2RGBFragmentShader(mInputFrameData->color_range == AVCOL_RANGE_JPEG);
+        case PIXEL_FORMAT_YUV420SP:
+        case PIXEL_FORMAT_NV21: {
+            std::string shader = GetNV12ToRGBFragmentShader(mInputFrameData->color_range == AVCOL_RANGE_JPEG,
+                                                            mInputFrameData->pixel_format == PIXEL_FORMAT_NV21);
             if (!InitWithFragmentShader(shader, 2)) {
                 error = "init yuv420sp shader error!";
             }
         }
             break;
+        case PIXEL_FORMAT_P010LE: {
+            std::string shader = GetP010ToRGBFragmentShader(mInputFrameData->color_range == AVCOL_RANGE_JPEG);
+            if (!InitWithFragmentShader(shader, 2)) {
+                error = "init p010le shader error!";
+            }
+        }
+            break;
         case PIXEL_FORMAT_VIDEOTOOLBOX: {
             std::string shader = GetYUV420sp2RGBFragmentShader(mInputFrameData->color_range == AVCOL_RANGE_JPEG);
             if (!InitWithFragmentShader(shader, 2)) {
@@ -71,9 +85,11 @@ int OpenGLFilter::init(VideoFrameMetaData *inputFrameMetaData,
             }
         }
             break;
-        case PIXEL_FORMAT_YUV420P10LE: {
+        case PIXEL_FORMAT_YUV420P10LE:
+        case PIXEL_FORMAT_YUV422P10LE:
+        case PIXEL_FORMAT_YUV444P10LE: {
             std::string shader = GetYUV420p10le2RGBFragmentShader(mInputFrameData->color_range == AVCOL_RANGE_JPEG);
-            if (!InitWithFragmentShader(shader, 2)) {
+            if (!InitWithFragmentShader(shader, 3)) {
                 error = "init yuv420p10le shader error!";
             }
         }
@@ -118,10 +134,9 @@ int OpenGLFilter::OnRender() {
         }
             break;
         default: {
-            if (mInputFrameData->pixel_format == PIXEL_FORMAT_YUV420P ||
-                mInputFrameData->pixel_format == PIXEL_FORMAT_YUV420SP ||
-                mInputFrameData->pixel_format == PIXEL_FORMAT_VIDEOTOOLBOX ||
-                mInputFrameData->pixel_format == PIXEL_FORMAT_YUV420P10LE) {
+            PlaneTexture planes[MAX_PLANE_TEXTURES];
+            if (GetPlaneTextures(mInputFrameData->pixel_format, planes) > 0 ||
+                mInputFrameData->pixel_format == PIXEL_FORMAT_VIDEOTOOLBOX) {
                 matrix = mInputFrameData->color_range == AVCOL_RANGE_JPEG ?
                          Bt709FullRangeYUV2RGBMatrix : Bt709LimitRangeYUV2RGBMatrix;
                 glUniformMatrix3fv(uColorConversion, 1, GL_FALSE, const_cast<GLfloat *>(matrix));
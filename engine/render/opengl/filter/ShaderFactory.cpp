@@ -3,6 +3,8 @@
  *       1. YUV420P
  *       2. YUV420SP
  *       3. YUV420P10LE
+ *       4. NV12/NV21 with a luminance alpha chroma texture
+ *       5. P010LE
  *
  * Date: 2025/12/21
  * Author: frank
@@ -113,6 +115,56 @@ static const std::string YUV420p10le2RGBFragmentShader =
         }
     );
 
+// uv of NV12 in the luminance and alpha of one texel, swapped for NV21
+static const std::string NV12ToRGBFragmentShader =
+    SHADER_STRING(
+        precision highp float;
+        varying vec2 vTexCoord;
+        varying vec2 vTexCoord1;
+        uniform mat3 uColorConversion;
+        uniform sampler2D colorMap;
+        uniform sampler2D colorMap1;
+
+        void main() {
+           vec3 yuv;
+           vec3 rgb;
+
+           yuv.x  = (texture2D(colorMap,  vTexCoord).r   - (16.0 / 255.0));
+           yuv.yz = (texture2D(colorMap1, vTexCoord1).ra - vec2(0.5, 0.5));
+           rgb    = uColorConversion * yuv;
+           gl_FragColor = vec4(rgb, 1);
+        }
+    );
+
+// 16 bit samples with 10 significant high bits, y as luminance alpha, uv as rgba
+static const std::string P010ToRGBFragmentShader =
+    SHADER_STRING(
+        precision highp float;
+        varying vec2 vTexCoord;
+        varying vec2 vTexCoord1;
+        uniform mat3 uColorConversion;
+        uniform sampler2D colorMap;
+        uniform sampler2D colorMap1;
+
+        void main() {
+           vec2 y;
+           vec4 uv;
+           vec3 yuv;
+           vec3 rgb;
+
+           y  = texture2D(colorMap,  vTexCoord).ra;
+           uv = texture2D(colorMap1, vTexCoord1);
+
+           yuv.x = (y.x  + y.y  * 256.0) * 255.0 / 65535.0;
+           yuv.y = (uv.r + uv.g * 256.0) * 255.0 / 65535.0;
+           yuv.z = (uv.b + uv.a * 256.0) * 255.0 / 65535.0;
+           yuv  -= vec3(16.0 / 255.0, 0.5, 0.5);
+
+           rgb = uColorConversion * yuv;
+           gl_FragColor = vec4(rgb, 1);
+        }
+    );
+
 std::string GetVertexShader() {
     return CommonVertexShader;
 }
@@ -175,3 +227,18 @@ std::string GetYUV420sp2RGBFragmentShader(bool fullRange) {
 std::string GetYUV420p10le2RGBFragmentShader(bool fullRange) {
     return HandleColorRange(YUV420p10le2RGBFragmentShader, fullRange);
 }
+
+std::string GetNV12ToRGBFragmentShader(bool fullRange, bool nv21) {
+    std::string shader = HandleColorRange(NV12ToRGBFragmentShader, fullRange);
+    if (nv21) {
+        size_t pos = shader.find(".ra");
+        if (pos != std::string::npos) {
+            shader.replace(pos, 3, ".ar");
+        }
+    }
+    return shader;
+}
+
+std::string GetP010ToRGBFragmentShader(bool fullRange) {
+    return HandleColorRange(P010ToRGBFragmentShader, fullRange);
+}
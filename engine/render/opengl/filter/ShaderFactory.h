@@ -10,5 +10,7 @@ std::string GetVertexShaderString(int textureNum);
 std::string GetYUV420p2RGBFragmentShader(bool fullRange);
 std::string GetYUV420sp2RGBFragmentShader(bool fullRange);
 std::string GetYUV420p10le2RGBFragmentShader(bool fullRange);
+std::string GetNV12ToRGBFragmentShader(bool fullRange, bool nv21);
+std::string GetP010ToRGBFragmentShader(bool fullRange);
 
 #endif // SHADER_FACTORY_H
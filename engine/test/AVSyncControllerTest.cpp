@@ -0,0 +1,56 @@
+/**
+ * Note: tests of the adaptive A/V sync controller
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "AVSyncController.h"
+
+TEST(AVSyncControllerTest, DropsBeyondOneFrameAndJitter) {
+    AVSyncController controller;
+    double frame = 1.0 / 60;
+    // no jitter measured yet, FRAME_DROP_THRESHOLD on top of the frame
+    EXPECT_FALSE(controller.ShouldDropFrame(frame + FRAME_DROP_THRESHOLD - 0.001, frame));
+    EXPECT_TRUE(controller.ShouldDropFrame(frame + FRAME_DROP_THRESHOLD + 0.001, frame));
+}
+
+TEST(AVSyncControllerTest, LongFramesAreNotDroppedEarly) {
+    AVSyncController controller;
+    // a 24fps frame late by less than its duration plus the noise margin
+    double frame = 1.0 / 24;
+    EXPECT_FALSE(controller.ShouldDropFrame(0.18, frame));
+    EXPECT_TRUE(controller.ShouldDropFrame(0.2, frame));
+}
+
+TEST(AVSyncControllerTest, CapsContinuousDrops) {
+    AVSyncController controller;
+    for (int i = 0; i < MAX_CONTINUE_DROP_FRAME; i++) {
+        EXPECT_TRUE(controller.ShouldDropFrame(1.0, 0.04));
+    }
+    EXPECT_FALSE(controller.ShouldDropFrame(1.0, 0.04));
+    controller.OnFrameRendered(0.04);
+    EXPECT_TRUE(controller.ShouldDropFrame(1.0, 0.04));
+}
+
+// a steady 120 Hz renderer keeps the margin at its floor, not near 0
+TEST(AVSyncControllerTest, SteadyRendererKeepsMinMargin) {
+    AVSyncController controller;
+    double frame = 1.0 / 120;
+    for (int i = 0; i < 40; i++) {
+        controller.OnFrameRendered(frame);
+        std::this_thread::sleep_for(std::chrono::microseconds(8333));
+    }
+    AVSyncStatistic stat;
+    controller.GetStatistic(stat);
+    ASSERT_GT(stat.render_jitter, 0);
+    EXPECT_FLOAT_EQ(stat.drop_threshold, AV_SYNC_THRESHOLD_MIN);
+
+    // a few ms past one frame is not late
+    EXPECT_FALSE(controller.ShouldDropFrame(frame + 0.005, frame));
+    EXPECT_FALSE(controller.ShouldDropFrame(frame + AV_SYNC_THRESHOLD_MIN - 0.001, frame));
+    EXPECT_TRUE(controller.ShouldDropFrame(frame + AV_SYNC_THRESHOLD_MIN + 0.001, frame));
+}
@@ -0,0 +1,193 @@
+/**
+ * Note: tests of the hls variant selection over a local http server
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "AdaptiveIO.h"
+#include "LocalHttpServer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/error.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define SEGMENT_COUNT 6
+#define SEGMENT_SIZE (256 * 1024)
+
+// every byte of a segment is the name of its variant
+static void AddVariant(LocalHttpServer &server, char name, int segments) {
+    std::string playlist = "#EXTM3U\n#EXT-X-TARGETDURATION:10\n";
+    for (int i = 0; i < segments; i++) {
+        std::string path = std::string("/") + name + std::to_string(i) + ".ts";
+        playlist += "#EXTINF:10.0,\n" + path.substr(1) + "\n";
+        server.SetFile(path, std::string(SEGMENT_SIZE, name));
+    }
+    playlist += "#EXT-X-ENDLIST\n";
+    server.SetFile(std::string("/") + name + ".m3u8", playlist);
+}
+
+static void AddMaster(LocalHttpServer &server) {
+    server.SetFile("/master.m3u8",
+                   "#EXTM3U\n"
+                   "#EXT-X-STREAM-INF:BANDWIDTH=800000,RESOLUTION=640x360,"
+                   "CODECS=\"avc1.4d401e,mp4a.40.2\"\n"
+                   "a.m3u8\n"
+                   "#EXT-X-STREAM-INF:BANDWIDTH=2400000,RESOLUTION=1280x720,"
+                   "CODECS=\"avc1.640028,mp4a.40.2\"\n"
+                   "b.m3u8\n"
+                   "#EXT-X-STREAM-INF:BANDWIDTH=5000000,RESOLUTION=1920x1080,"
+                   "CODECS=\"hvc1.1.6.L120.90,mp4a.40.2\"\n"
+                   "c.m3u8\n");
+}
+
+// the variant name of the next segment, 0 if its bytes are mixed
+static char ReadSegment(AVIOContext *pb) {
+    std::vector<uint8_t> buf(SEGMENT_SIZE);
+    if (avio_read(pb, buf.data(), SEGMENT_SIZE) != SEGMENT_SIZE) {
+        return 0;
+    }
+    for (uint8_t c : buf) {
+        if (c != buf[0]) {
+            return 0;
+        }
+    }
+    return static_cast<char>(buf[0]);
+}
+
+class AdaptiveIOTest : public testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(server.Start());
+        AddMaster(server);
+        AddVariant(server, 'a', SEGMENT_COUNT);
+        AddVariant(server, 'b', SEGMENT_COUNT);
+        AddVariant(server, 'c', SEGMENT_COUNT);
+        // long enough for a bandwidth sample, far above every variant
+        server.SetDelay(60);
+    }
+
+    LocalHttpServer server;
+};
+
+TEST(HlsPlaylistTest, SameCodecs) {
+    EXPECT_TRUE(HlsPlaylist::SameCodecs("avc1.4d401e,mp4a.40.2", "mp4a.40.5, avc1.640028"));
+    EXPECT_TRUE(HlsPlaylist::SameCodecs("avc3.64001f", "avc1.640028"));
+    EXPECT_TRUE(HlsPlaylist::SameCodecs("", ""));
+    EXPECT_FALSE(HlsPlaylist::SameCodecs("avc1.640028,mp4a.40.2", "hvc1.1.6.L120.90,mp4a.40.2"));
+    EXPECT_FALSE(HlsPlaylist::SameCodecs("avc1.640028", "avc1.640028,mp4a.40.2"));
+    EXPECT_FALSE(HlsPlaylist::SameCodecs("avc1.640028", ""));
+}
+
+TEST_F(AdaptiveIOTest, SwitchesToCompatibleVariant) {
+    AdaptiveIO io;
+    AVIOInterruptCB cb {};
+    ASSERT_EQ(io.Open(server.Url("/master.m3u8"), nullptr, cb, 3), 0);
+    AVIOContext *pb = io.GetContext();
+    AdaptiveStatistic stat;
+    io.GetStatistic(stat);
+    EXPECT_EQ(stat.width, 640);
+
+    std::string names;
+    bool switched = false;
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        names += ReadSegment(pb);
+        if (io.TakeSwitch(stat)) {
+            EXPECT_FALSE(switched);
+            switched = true;
+            // reported when the demuxer reaches the bytes of the new variant
+            EXPECT_EQ(names.back(), 'b');
+            EXPECT_EQ(stat.switch_reason, ADAPTIVE_SWITCH_UP);
+            EXPECT_EQ(stat.width, 1280);
+            EXPECT_EQ(stat.height, 720);
+        }
+        // let the prefetch finish so that the buffer isn't low
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    }
+    uint8_t byte;
+    EXPECT_EQ(avio_read(pb, &byte, 1), AVERROR_EOF);
+    io.Close();
+
+    // the hevc variant is never mixed into the avc stream
+    EXPECT_EQ(names.size(), static_cast<size_t>(SEGMENT_COUNT));
+    EXPECT_EQ(names.find_first_not_of("ab"), std::string::npos) << names;
+    EXPECT_EQ(names.front(), 'a');
+    EXPECT_EQ(names.back(), 'b') << names;
+    EXPECT_TRUE(switched);
+}
+
+TEST_F(AdaptiveIOTest, ErrorFallsBackToLowerVariant) {
+    server.RemoveFile("/b4.ts");
+    AdaptiveIO io;
+    AVIOInterruptCB cb {};
+    ASSERT_EQ(io.Open(server.Url("/master.m3u8"), nullptr, cb, 3), 0);
+    AVIOContext *pb = io.GetContext();
+
+    std::string names;
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        names += ReadSegment(pb);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    }
+    io.Close();
+    // the missing segment comes from the default variant
+    ASSERT_EQ(names.size(), static_cast<size_t>(SEGMENT_COUNT));
+    EXPECT_EQ(names[4], 'a') << names;
+}
+
+TEST_F(AdaptiveIOTest, FallbackNeedsTheSegment) {
+    // the default variant ends before the failing segment
+    AddVariant(server, 'a', 4);
+    server.RemoveFile("/b4.ts");
+    AdaptiveIO io;
+    AVIOInterruptCB cb {};
+    ASSERT_EQ(io.Open(server.Url("/master.m3u8"), nullptr, cb, 3), 0);
+    AVIOContext *pb = io.GetContext();
+
+    std::string names;
+    for (int i = 0; i < 4; i++) {
+        names += ReadSegment(pb);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    }
+    // retried from the same variant, then reported
+    std::vector<uint8_t> buf(SEGMENT_SIZE);
+    EXPECT_LT(avio_read(pb, buf.data(), SEGMENT_SIZE), 0);
+    io.Close();
+    EXPECT_EQ(names, "aaaa");
+}
+
+// loop playback: a seek after the end reads the stream again
+TEST_F(AdaptiveIOTest, SeekAfterEof) {
+    AdaptiveIO io;
+    AVIOInterruptCB cb {};
+    ASSERT_EQ(io.Open(server.Url("/master.m3u8"), nullptr, cb, 3), 0);
+    AVIOContext *pb = io.GetContext();
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        ASSERT_NE(ReadSegment(pb), 0);
+    }
+    uint8_t byte;
+    ASSERT_EQ(avio_read(pb, &byte, 1), AVERROR_EOF);
+    ASSERT_EQ(pb->eof_reached, 1);
+
+    // as NextExtractor::Seek does, the flush alone leaves the eof flag set
+    ASSERT_EQ(io.SeekTime(0), 0);
+    avio_flush(pb);
+    EXPECT_EQ(pb->eof_reached, 1);
+    pb->eof_reached = 0;
+
+    std::string names;
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        names += ReadSegment(pb);
+    }
+    EXPECT_EQ(avio_read(pb, &byte, 1), AVERROR_EOF);
+    io.Close();
+    EXPECT_EQ(names.size(), static_cast<size_t>(SEGMENT_COUNT));
+    EXPECT_EQ(names.find('\0'), std::string::npos);
+}
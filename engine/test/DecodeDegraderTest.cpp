@@ -0,0 +1,95 @@
+/**
+ * Note: tests of the skip level picked from the decode rate
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include "decode/DecodeDegrader.h"
+
+#define TEST_FPS 30
+
+class DecodeDegraderTest : public testing::Test {
+protected:
+    void SetUp() override {
+        degrader.SetFrameRate(TEST_FPS);
+    }
+
+    // one window of packets at the frame rate, each decoded at decodeRate,
+    // returns the level after it
+    int RunWindow(double decodeRate) {
+        auto busy = static_cast<int64_t>(1000000 / decodeRate);
+        int64_t interval = 1000000 / TEST_FPS;
+        for (int i = 0; i < TEST_FPS; i++) {
+            degrader.AddSample(mNowUs + i * interval, busy);
+        }
+        // closes the window
+        degrader.AddSample(mNowUs + DEGRADE_WINDOW_US, busy);
+        mNowUs += DEGRADE_WINDOW_US + interval;
+        return degrader.GetLevel();
+    }
+
+    DecodeDegrader degrader;
+    int64_t mNowUs = 0;
+};
+
+TEST_F(DecodeDegraderTest, DisabledWithoutFrameRate) {
+    degrader.SetFrameRate(0);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(RunWindow(5), 0);
+    }
+    EXPECT_EQ(degrader.GetDecodeRate(), 0);
+}
+
+TEST_F(DecodeDegraderTest, DecodeRateOfWindow) {
+    RunWindow(20);
+    EXPECT_NEAR(degrader.GetDecodeRate(), 20, 0.01);
+}
+
+TEST_F(DecodeDegraderTest, RaisesAfterSlowWindows) {
+    for (int i = 1; i < DEGRADE_RAISE_WINDOWS; i++) {
+        EXPECT_EQ(RunWindow(TEST_FPS * 0.5), 0);
+    }
+    EXPECT_EQ(RunWindow(TEST_FPS * 0.5), 1);
+}
+
+TEST_F(DecodeDegraderTest, StopsAtMaxLevel) {
+    for (int i = 0; i < DEGRADE_RAISE_WINDOWS * (DEGRADE_MAX_LEVEL + 2); i++) {
+        RunWindow(TEST_FPS * 0.5);
+    }
+    EXPECT_EQ(degrader.GetLevel(), DEGRADE_MAX_LEVEL);
+}
+
+// a window within the margin breaks the run of slow windows
+TEST_F(DecodeDegraderTest, NormalWindowResetsCount) {
+    for (int i = 0; i < 5; i++) {
+        RunWindow(TEST_FPS * 0.5);
+        EXPECT_EQ(RunWindow(TEST_FPS * 1.2), 0);
+    }
+}
+
+TEST_F(DecodeDegraderTest, LowersSlowerThanRaises) {
+    for (int i = 0; i < DEGRADE_RAISE_WINDOWS; i++) {
+        RunWindow(TEST_FPS * 0.5);
+    }
+    ASSERT_EQ(degrader.GetLevel(), 1);
+    for (int i = 1; i < DEGRADE_LOWER_WINDOWS; i++) {
+        EXPECT_EQ(RunWindow(TEST_FPS * 2), 1);
+    }
+    EXPECT_EQ(RunWindow(TEST_FPS * 2), 0);
+    // never below the configured level
+    for (int i = 0; i < DEGRADE_LOWER_WINDOWS; i++) {
+        EXPECT_EQ(RunWindow(TEST_FPS * 2), 0);
+    }
+}
+
+TEST_F(DecodeDegraderTest, ResetKeepsLevel) {
+    for (int i = 0; i < DEGRADE_RAISE_WINDOWS; i++) {
+        RunWindow(TEST_FPS * 0.5);
+    }
+    degrader.Reset();
+    EXPECT_EQ(degrader.GetLevel(), 1);
+    // the samples before the reset do not count
+    EXPECT_FALSE(degrader.AddSample(mNowUs + DEGRADE_WINDOW_US * 10, 1000000));
+    EXPECT_EQ(degrader.GetLevel(), 1);
+}
@@ -0,0 +1,134 @@
+/**
+ * Note: tests of the disk cache over a local http server
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "DiskCache.h"
+#include "DiskCacheIO.h"
+#include "LocalHttpServer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/error.h"
+#ifdef __cplusplus
+}
+#endif
+
+// a partial last block
+#define SOURCE_SIZE (5 * DISK_CACHE_BLOCK_SIZE + 1000)
+
+static std::string MakeSource(int seed) {
+    std::string data(SOURCE_SIZE, 0);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>((i + seed) % 251);
+    }
+    return data;
+}
+
+// true if the bytes from pos to the end match the source
+static bool ReadToEnd(AVIOContext *pb, int64_t pos, int seed) {
+    std::vector<uint8_t> buf(64 * 1024);
+    int ret;
+    while ((ret = avio_read(pb, buf.data(), static_cast<int>(buf.size()))) > 0) {
+        for (int i = 0; i < ret; i++) {
+            if (buf[i] != static_cast<uint8_t>((pos + i + seed) % 251)) {
+                return false;
+            }
+        }
+        pos += ret;
+    }
+    return ret == AVERROR_EOF && pos == SOURCE_SIZE;
+}
+
+class DiskCacheTest : public testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(server.Start());
+        server.SetFile("/a.mp4", MakeSource(0));
+        server.SetFile("/b.mp4", MakeSource(7));
+        char dir[] = "/tmp/disk_cache_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        mDir = dir;
+    }
+
+    void TearDown() override {
+        std::string cmd = "rm -rf " + mDir;
+        ASSERT_EQ(system(cmd.c_str()), 0);
+    }
+
+    static bool ReadUrl(const std::shared_ptr<DiskCache> &cache, const std::string &url,
+                        int64_t seekPos, int seed) {
+        DiskCacheIO io(cache);
+        AVIOInterruptCB cb {};
+        if (io.Open(url, nullptr, cb) < 0) {
+            return false;
+        }
+        AVIOContext *pb = io.GetContext();
+        if (seekPos > 0 && avio_seek(pb, seekPos, SEEK_SET) != seekPos) {
+            return false;
+        }
+        bool ok = ReadToEnd(pb, seekPos, seed);
+        io.Close();
+        return ok;
+    }
+
+    LocalHttpServer server;
+    std::string mDir;
+};
+
+TEST_F(DiskCacheTest, SecondReadFromDisk) {
+    auto cache = std::make_shared<DiskCache>(mDir);
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/a.mp4"), 0, 0));
+    DiskCacheStat first = cache->GetStat();
+    EXPECT_EQ(first.total_bytes, SOURCE_SIZE);
+    EXPECT_EQ(first.hit_bytes, 0);
+
+    int requests = server.Requests();
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/a.mp4"), 0, 0));
+    DiskCacheStat second = cache->GetStat();
+    EXPECT_EQ(second.hit_bytes, SOURCE_SIZE);
+    // at most the open of the connection, no block is fetched again
+    EXPECT_LE(server.Requests() - requests, 1);
+}
+
+TEST_F(DiskCacheTest, SeekFetchesRange) {
+    auto cache = std::make_shared<DiskCache>(mDir);
+    // the middle of a block, the blocks before are never fetched
+    int64_t pos = 3 * DISK_CACHE_BLOCK_SIZE + 100;
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/a.mp4"), pos, 0));
+    EXPECT_EQ(cache->GetStat().total_bytes, SOURCE_SIZE - 3 * DISK_CACHE_BLOCK_SIZE);
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/a.mp4"), 0, 0));
+    EXPECT_EQ(cache->GetStat().hit_bytes, SOURCE_SIZE - 3 * DISK_CACHE_BLOCK_SIZE);
+}
+
+TEST_F(DiskCacheTest, IndexSurvivesRestart) {
+    {
+        auto cache = std::make_shared<DiskCache>(mDir);
+        ASSERT_TRUE(ReadUrl(cache, server.Url("/a.mp4"), 0, 0));
+    }
+    auto cache = std::make_shared<DiskCache>(mDir);
+    EXPECT_EQ(cache->GetStat().total_bytes, SOURCE_SIZE);
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/a.mp4"), 0, 0));
+    EXPECT_EQ(cache->GetStat().hit_bytes, SOURCE_SIZE);
+}
+
+TEST_F(DiskCacheTest, EvictsUnusedEntry) {
+    // room for one source and a half
+    auto cache = std::make_shared<DiskCache>(mDir, SOURCE_SIZE * 3 / 2);
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/a.mp4"), 0, 0));
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/b.mp4"), 0, 7));
+    DiskCacheStat stat = cache->GetStat();
+    EXPECT_GE(stat.evict_bytes, SOURCE_SIZE);
+    EXPECT_LE(stat.total_bytes, SOURCE_SIZE * 3 / 2);
+
+    // the entry read last stays
+    ASSERT_TRUE(ReadUrl(cache, server.Url("/b.mp4"), 0, 7));
+    EXPECT_EQ(cache->GetStat().hit_bytes, SOURCE_SIZE);
+}
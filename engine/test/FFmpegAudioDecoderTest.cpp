@@ -0,0 +1,138 @@
+/**
+ * Note: tests of the audio decoder drain loop and batching, on pcm packets
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "NextErrorCode.h"
+#include "decode/FFmpegAudioDecoder.h"
+
+#define TEST_SAMPLE_RATE 48000
+#define TEST_CHANNELS 2
+// 2.5ms, as small as an opus frame gets
+#define TEST_SMALL_FRAME 120
+
+// the samples of every frame handed to the renderer
+class CollectingCallback : public AudioDecodeCallback {
+public:
+    int OnDecodedFrame(AVFrame *frame) override {
+        mSamples.push_back(frame->nb_samples);
+        mPts.push_back(frame->pts);
+        av_frame_free(&frame);
+        return RESULT_OK;
+    }
+
+    void OnDecodeError(int error) override {}
+
+    int Total() const {
+        int total = 0;
+        for (int samples : mSamples) {
+            total += samples;
+        }
+        return total;
+    }
+
+    std::vector<int> mSamples;
+    std::vector<int64_t> mPts;
+};
+
+class FFmpegAudioDecoderTest : public testing::Test {
+protected:
+    void SetUp() override {
+        // the decoder touches AVCodecContext and AVFrame fields,
+        // a runtime of another major has another layout
+        if (AV_VERSION_MAJOR(avcodec_version()) != LIBAVCODEC_VERSION_MAJOR) {
+            GTEST_SKIP() << "libavcodec runtime does not match the headers";
+        }
+        pkt = av_packet_alloc();
+    }
+
+    void TearDown() override {
+        av_packet_free(&pkt);
+        decoder.Release();
+    }
+
+    void Open(int batchMs) {
+        AudioCodecConfig config;
+        config.codec_id    = AV_CODEC_ID_PCM_S16LE;
+        config.channels    = TEST_CHANNELS;
+        config.sample_rate = TEST_SAMPLE_RATE;
+        config.batch_ms    = batchMs;
+        decoder.SetDecodeCallback(&callback);
+        ASSERT_EQ(decoder.Init(config), RESULT_OK);
+    }
+
+    int Send(int samples) {
+        av_packet_unref(pkt);
+        int size = samples * TEST_CHANNELS * 2;
+        if (av_new_packet(pkt, size) < 0) {
+            return AVERROR(ENOMEM);
+        }
+        memset(pkt->data, 0, size);
+        pkt->pts = mPts;
+        mPts += samples;
+        return decoder.Decode(pkt);
+    }
+
+    int Drain() {
+        return decoder.Decode(nullptr);
+    }
+
+    FFmpegAudioDecoder decoder;
+    CollectingCallback callback;
+    AVPacket *pkt = nullptr;
+    int64_t mPts = 0;
+};
+
+TEST_F(FFmpegAudioDecoderTest, OutputsEveryFrame) {
+    Open(0);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(Send(TEST_SMALL_FRAME), RESULT_OK);
+        // nothing held back in the codec
+        EXPECT_EQ(callback.mSamples.size(), static_cast<size_t>(i + 1));
+    }
+    EXPECT_EQ(Drain(), ERROR_PLAYER_EOF);
+    EXPECT_EQ(callback.Total(), 10 * TEST_SMALL_FRAME);
+}
+
+TEST_F(FFmpegAudioDecoderTest, BatchesSmallFrames) {
+    Open(20);
+    int batch = TEST_SAMPLE_RATE * 20 / 1000;
+    for (int i = 0; i < 20; i++) {
+        ASSERT_EQ(Send(TEST_SMALL_FRAME), RESULT_OK);
+    }
+    ASSERT_EQ(callback.mSamples.size(), 2u);
+    EXPECT_EQ(callback.mSamples[0], batch);
+    EXPECT_EQ(callback.mSamples[1], batch);
+    // timestamps of a batch are its first frame's
+    EXPECT_EQ(callback.mPts[1], batch);
+
+    // the tail goes out on eof
+    EXPECT_EQ(Drain(), ERROR_PLAYER_EOF);
+    ASSERT_EQ(callback.mSamples.size(), 3u);
+    EXPECT_EQ(callback.Total(), 20 * TEST_SMALL_FRAME);
+}
+
+TEST_F(FFmpegAudioDecoderTest, LargeFrameNotBatched) {
+    Open(20);
+    int large = TEST_SAMPLE_RATE * 40 / 1000;
+    ASSERT_EQ(Send(large), RESULT_OK);
+    ASSERT_EQ(callback.mSamples.size(), 1u);
+    EXPECT_EQ(callback.mSamples[0], large);
+}
+
+// samples from before a seek never reach the renderer
+TEST_F(FFmpegAudioDecoderTest, FlushDropsBatch) {
+    Open(20);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(Send(TEST_SMALL_FRAME), RESULT_OK);
+    }
+    ASSERT_TRUE(callback.mSamples.empty());
+    decoder.Flush();
+    EXPECT_EQ(Drain(), ERROR_PLAYER_EOF);
+    EXPECT_TRUE(callback.mSamples.empty());
+}
@@ -0,0 +1,183 @@
+
+#ifndef LOCAL_HTTP_SERVER_H
+#define LOCAL_HTTP_SERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * HTTP/1.1 server on 127.0.0.1 for tests: GET of in-memory files with
+ * single byte ranges, one connection per request. Unknown paths get 404,
+ * every response body is held back for the configured delay.
+ */
+class LocalHttpServer {
+public:
+    ~LocalHttpServer() {
+        Stop();
+    }
+
+    bool Start() {
+        mListenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (mListenFd < 0) {
+            return false;
+        }
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (bind(mListenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0
+            || listen(mListenFd, 16) < 0
+            || getsockname(mListenFd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) {
+            close(mListenFd);
+            mListenFd = -1;
+            return false;
+        }
+        mPort = ntohs(addr.sin_port);
+        mAcceptThread = std::thread(&LocalHttpServer::AcceptLoop, this);
+        return true;
+    }
+
+    void Stop() {
+        if (mListenFd < 0) {
+            return;
+        }
+        bStop = true;
+        shutdown(mListenFd, SHUT_RDWR);
+        mAcceptThread.join();
+        close(mListenFd);
+        mListenFd = -1;
+        for (auto &thread : mConnections) {
+            thread.join();
+        }
+        mConnections.clear();
+    }
+
+    std::string Url(const std::string &path) const {
+        return "http://127.0.0.1:" + std::to_string(mPort) + path;
+    }
+
+    void SetFile(const std::string &path, const std::string &data) {
+        std::lock_guard<std::mutex> lock(mLock);
+        mFiles[path] = data;
+    }
+
+    void RemoveFile(const std::string &path) {
+        std::lock_guard<std::mutex> lock(mLock);
+        mFiles.erase(path);
+    }
+
+    void SetDelay(int delayMs) {
+        mDelayMs = delayMs;
+    }
+
+    // GET requests received so far
+    int Requests() const {
+        return mRequests;
+    }
+
+private:
+    void AcceptLoop() {
+        while (!bStop) {
+            int fd = accept(mListenFd, nullptr, nullptr);
+            if (fd < 0) {
+                break;
+            }
+            mConnections.emplace_back(&LocalHttpServer::Serve, this, fd);
+        }
+    }
+
+    void Serve(int fd) {
+        std::string request;
+        char buf[4096];
+        while (request.find("\r\n\r\n") == std::string::npos) {
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            if (len <= 0) {
+                close(fd);
+                return;
+            }
+            request.append(buf, len);
+        }
+        mRequests++;
+        size_t begin = request.find(' ') + 1;
+        std::string path = request.substr(begin, request.find(' ', begin) - begin);
+        std::string body;
+        bool found;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            auto it = mFiles.find(path);
+            found = it != mFiles.end();
+            if (found) {
+                body = it->second;
+            }
+        }
+        std::string header;
+        if (!found) {
+            header = "HTTP/1.1 404 Not Found\r\n";
+        } else {
+            size_t size = body.size();
+            size_t start = 0;
+            size_t end = size;
+            size_t range = request.find("Range: bytes=");
+            if (range != std::string::npos) {
+                char *next = nullptr;
+                start = strtoull(request.c_str() + range + 13, &next, 10);
+                if (*next == '-' && next[1] >= '0' && next[1] <= '9') {
+                    end = std::min<size_t>(strtoull(next + 1, nullptr, 10) + 1, size);
+                }
+            }
+            if (start >= size && size > 0) {
+                header = "HTTP/1.1 416 Range Not Satisfiable\r\n";
+                body.clear();
+            } else if (range != std::string::npos) {
+                header = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes "
+                         + std::to_string(start) + "-" + std::to_string(end - 1) + "/"
+                         + std::to_string(size) + "\r\n";
+                body = body.substr(start, end - start);
+            } else {
+                header = "HTTP/1.1 200 OK\r\n";
+            }
+            header += "Accept-Ranges: bytes\r\n";
+        }
+        header += "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                  + "Connection: close\r\n\r\n";
+        send(fd, header.data(), header.size(), MSG_NOSIGNAL);
+        if (mDelayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(mDelayMs));
+        }
+        size_t sent = 0;
+        while (sent < body.size()) {
+            ssize_t len = send(fd, body.data() + sent, body.size() - sent, MSG_NOSIGNAL);
+            if (len <= 0) {
+                break;
+            }
+            sent += len;
+        }
+        close(fd);
+    }
+
+private:
+    int mListenFd = -1;
+    int mPort     = 0;
+    std::thread mAcceptThread;
+    std::vector<std::thread> mConnections;
+    std::atomic_bool bStop {false};
+    std::atomic_int mDelayMs {0};
+    std::atomic_int mRequests {0};
+
+    std::mutex mLock;
+    std::map<std::string, std::string> mFiles;
+};
+
+#endif //LOCAL_HTTP_SERVER_H
@@ -0,0 +1,90 @@
+/**
+ * Note: tests of the mmap io layer
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+
+#include "MmapIO.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/error.h"
+#ifdef __cplusplus
+}
+#endif
+
+class MmapIOTest : public testing::Test {
+protected:
+    void SetUp() override {
+        char path[] = "/tmp/mmap_io_XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        mPath = path;
+        Append(0, 1024 * 1024);
+    }
+
+    void TearDown() override {
+        unlink(mPath.c_str());
+    }
+
+    void Append(int64_t pos, int size) {
+        std::vector<uint8_t> data(size);
+        for (int i = 0; i < size; i++) {
+            data[i] = static_cast<uint8_t>((pos + i) % 251);
+        }
+        FILE *fp = fopen(mPath.c_str(), "ab");
+        ASSERT_NE(fp, nullptr);
+        ASSERT_EQ(fwrite(data.data(), 1, data.size(), fp), data.size());
+        fclose(fp);
+    }
+
+    static int64_t ReadAll(AVIOContext *pb, int64_t pos) {
+        std::vector<uint8_t> buf(64 * 1024);
+        int ret;
+        while ((ret = avio_read(pb, buf.data(), static_cast<int>(buf.size()))) > 0) {
+            for (int i = 0; i < ret; i++) {
+                if (buf[i] != static_cast<uint8_t>((pos + i) % 251)) {
+                    return -1;
+                }
+            }
+            pos += ret;
+        }
+        return pos;
+    }
+
+    std::string mPath;
+};
+
+TEST_F(MmapIOTest, ReadsGrowingFile) {
+    MmapIO io;
+    ASSERT_EQ(io.Open("file:" + mPath), 0);
+    AVIOContext *pb = io.GetContext();
+    EXPECT_EQ(ReadAll(pb, 0), 1024 * 1024);
+
+    // written while played, e.g. a recording
+    Append(1024 * 1024, 512 * 1024);
+    pb->eof_reached = 0;
+    EXPECT_EQ(ReadAll(pb, 1024 * 1024), 1536 * 1024);
+    EXPECT_EQ(avio_size(pb), 1536 * 1024);
+    io.Close();
+}
+
+TEST_F(MmapIOTest, StopsAtTruncatedEnd) {
+    MmapIO io;
+    ASSERT_EQ(io.Open(mPath), 0);
+    AVIOContext *pb = io.GetContext();
+    ASSERT_EQ(truncate(mPath.c_str(), 256 * 1024), 0);
+    EXPECT_EQ(avio_size(pb), 256 * 1024);
+    // past the new end is eof instead of a fault on the dropped pages
+    ASSERT_EQ(avio_seek(pb, 512 * 1024, SEEK_SET), 512 * 1024);
+    uint8_t buf[16];
+    EXPECT_EQ(avio_read(pb, buf, sizeof(buf)), AVERROR_EOF);
+    io.Close();
+}
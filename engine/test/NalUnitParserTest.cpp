@@ -0,0 +1,35 @@
+/**
+ * Note: tests of the NAL unit header parser
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include "NalUnitParser.h"
+
+TEST(NalUnitParserTest, H264Header) {
+    // start code + nal_ref_idc 3, IDR slice
+    const uint8_t idr[] = {0, 0, 0, 1, 0x65};
+    EXPECT_EQ(NALUnitParser::get_h264_nal_unit_type(idr), NAL_IDR_SLICE);
+    EXPECT_EQ(NALUnitParser::get_h264_ref_idc(idr), 3);
+    EXPECT_TRUE(NALUnitParser::is_h264_idr(NALUnitParser::get_h264_nal_unit_type(idr)));
+}
+
+TEST(NalUnitParserTest, HevcHeader) {
+    // IDR_W_RADL, nuh_layer_id 0, tid 1
+    const uint8_t idr[] = {0, 0, 0, 1, 0x26, 0x01};
+    EXPECT_EQ(NALUnitParser::get_hevc_nal_unit_type(idr), HEVC_NAL_IDR_W_RADL);
+    EXPECT_EQ(NALUnitParser::get_hevc_nuh_layer_id(idr), 0);
+    EXPECT_TRUE(NALUnitParser::is_hevc_idr(HEVC_NAL_IDR_W_RADL));
+    EXPECT_TRUE(NALUnitParser::is_hevc_no_ref(HEVC_NAL_TRAIL_N));
+}
+
+TEST(NalUnitParserTest, HevcLayerId) {
+    // the 6 bits straddle the two header bytes
+    const uint8_t layer1[]  = {0, 0, 0, 1, 0x02, 0x09};
+    const uint8_t layer32[] = {0, 0, 0, 1, 0x03, 0x01};
+    const uint8_t layer63[] = {0, 0, 0, 1, 0x03, 0xF9};
+    EXPECT_EQ(NALUnitParser::get_hevc_nuh_layer_id(layer1), 1);
+    EXPECT_EQ(NALUnitParser::get_hevc_nuh_layer_id(layer32), 32);
+    EXPECT_EQ(NALUnitParser::get_hevc_nuh_layer_id(layer63), 63);
+}
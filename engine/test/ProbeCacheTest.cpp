@@ -0,0 +1,167 @@
+/**
+ * Note: tests of the probe cache
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <utime.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include "ProbeCache.h"
+
+static ProbeValidator MakeValidator(int64_t size) {
+    ProbeValidator validator;
+    validator.size = size;
+    return validator;
+}
+
+static MetaData MakeMetaData() {
+    MetaData metadata;
+    metadata.duration = 10 * 1000 * 1000;
+    TrackInfo info;
+    info.codec_id = 27;
+    info.stream_type = 0;
+    info.width  = 1920;
+    info.height = 1080;
+    const uint8_t extra[] = {1, 0x64, 0, 0x28, 0xFF};
+    info.extra_data = MakeExtraData(extra, sizeof(extra));
+    metadata.track_info.push_back(info);
+    return metadata;
+}
+
+// the files written so far look an hour old
+static void AgeFiles(const std::string &dir) {
+    DIR *d = opendir(dir.c_str());
+    ASSERT_NE(d, nullptr);
+    struct dirent *ent;
+    while ((ent = readdir(d)) != nullptr) {
+        if (ent->d_name[0] != '.') {
+            struct utimbuf times {};
+            times.actime  = time(nullptr) - 3600;
+            times.modtime = times.actime;
+            utime((dir + "/" + ent->d_name).c_str(), &times);
+        }
+    }
+    closedir(d);
+}
+
+static void RemoveDir(const std::string &dir) {
+    std::string cmd = "rm -rf " + dir;
+    ASSERT_EQ(system(cmd.c_str()), 0);
+}
+
+TEST(ProbeCacheTest, EvictsLeastRecentlyUsed) {
+    ProbeCache cache;
+    MetaData metadata = MakeMetaData();
+    for (int i = 0; i < PROBE_CACHE_MAX_ENTRY; i++) {
+        cache.Store("http://host/" + std::to_string(i), MakeValidator(100), metadata);
+    }
+    ProbeCacheEntry entry;
+    // the first one stored is the most recently used now
+    ASSERT_TRUE(cache.Lookup("http://host/0", MakeValidator(100), entry));
+    cache.Store("http://host/new", MakeValidator(100), metadata);
+    EXPECT_TRUE(cache.Lookup("http://host/0", MakeValidator(100), entry));
+    EXPECT_FALSE(cache.Lookup("http://host/1", MakeValidator(100), entry));
+    EXPECT_TRUE(cache.Lookup("http://host/new", MakeValidator(100), entry));
+}
+
+TEST(ProbeCacheTest, StoreKeepsKeyframes) {
+    ProbeCache cache;
+    MetaData metadata = MakeMetaData();
+    std::string url = "http://host/a.flv";
+    cache.Store(url, MakeValidator(100), metadata);
+
+    KeyframeIndex index;
+    index.Reset(0);
+    index.Add(0, 0);
+    index.Add(2 * 1000 * 1000, 4096);
+    cache.StoreKeyframes(url, MakeValidator(100), index);
+
+    // probed again, e.g. after a failed header check of another stream
+    cache.Store(url, MakeValidator(100), metadata);
+    ProbeCacheEntry entry;
+    ASSERT_TRUE(cache.Lookup(url, MakeValidator(100), entry));
+    EXPECT_EQ(entry.keyframe_stream, 0);
+    EXPECT_EQ(entry.keyframes.size(), 2u);
+
+    // another version of the source starts over
+    cache.Store(url, MakeValidator(200), metadata);
+    ASSERT_TRUE(cache.Lookup(url, MakeValidator(200), entry));
+    EXPECT_TRUE(entry.keyframes.empty());
+}
+
+TEST(ProbeCacheTest, KeyframesOfEvictedEntry) {
+    char dir[] = "/tmp/probe_cache_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    {
+        ProbeCache cache(dir);
+        MetaData metadata = MakeMetaData();
+        std::string url = "http://host/0";
+        cache.Store(url, MakeValidator(100), metadata);
+        for (int i = 1; i <= PROBE_CACHE_MAX_ENTRY; i++) {
+            cache.Store("http://host/" + std::to_string(i), MakeValidator(100), metadata);
+        }
+        // only in the file now
+        KeyframeIndex index;
+        index.Reset(0);
+        index.Add(0, 0);
+        cache.StoreKeyframes(url, MakeValidator(100), index);
+
+        ProbeCache reopened(dir);
+        ProbeCacheEntry entry;
+        ASSERT_TRUE(reopened.Lookup(url, MakeValidator(100), entry));
+        EXPECT_EQ(entry.keyframes.size(), 1u);
+        ASSERT_NE(entry.track_info[0].extra_data, nullptr);
+        EXPECT_EQ(entry.track_info[0].extra_data->size(), 5u);
+    }
+    RemoveDir(dir);
+}
+
+// entries loaded from disk count against the memory limit too
+TEST(ProbeCacheTest, EvictsLoadedEntry) {
+    char dir[] = "/tmp/probe_cache_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    {
+        ProbeCache writer(dir);
+        MetaData metadata = MakeMetaData();
+        for (int i = 0; i <= PROBE_CACHE_MAX_ENTRY; i++) {
+            writer.Store("http://host/" + std::to_string(i), MakeValidator(100), metadata);
+        }
+    }
+    ProbeCache cache(dir);
+    ProbeCacheEntry entry;
+    for (int i = 0; i <= PROBE_CACHE_MAX_ENTRY; i++) {
+        ASSERT_TRUE(cache.Lookup("http://host/" + std::to_string(i), MakeValidator(100), entry));
+    }
+    // with the files gone only the memory copies are left
+    RemoveDir(dir);
+    EXPECT_FALSE(cache.Lookup("http://host/0", MakeValidator(100), entry));
+    EXPECT_TRUE(cache.Lookup("http://host/" + std::to_string(PROBE_CACHE_MAX_ENTRY),
+                             MakeValidator(100), entry));
+}
+
+TEST(ProbeCacheTest, TrimsOldestFiles) {
+    char dir[] = "/tmp/probe_cache_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    MetaData metadata = MakeMetaData();
+    {
+        ProbeCache cache(dir, 4);
+        cache.Store("http://host/old", MakeValidator(100), metadata);
+        AgeFiles(dir);
+        for (int i = 0; i < 4; i++) {
+            cache.Store("http://host/" + std::to_string(i), MakeValidator(100), metadata);
+        }
+    }
+    ProbeCache reopened(dir, 4);
+    ProbeCacheEntry entry;
+    EXPECT_FALSE(reopened.Lookup("http://host/old", MakeValidator(100), entry));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(reopened.Lookup("http://host/" + std::to_string(i), MakeValidator(100), entry));
+    }
+    RemoveDir(dir);
+}
@@ -0,0 +1,159 @@
+/**
+ * Note: wakeup latency of the player queues on seek and stop
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "NextErrorCode.h"
+#include "NextFrameQueue.h"
+#include "NextPacketQueue.h"
+
+// far above a wakeup, far below a hang
+#define WAKEUP_LIMIT_MS 100
+
+static int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ms from the trigger to the return of the blocked call,
+// a missed wakeup hangs here until the ctest timeout
+template<typename Call, typename Trigger>
+static int64_t WakeupLatency(Call call, Trigger trigger) {
+    int64_t end = 0;
+    std::thread waiter([&] {
+        call();
+        end = NowMs();
+    });
+    // long enough for the waiter to block
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    int64_t start = NowMs();
+    trigger();
+    waiter.join();
+    return end - start;
+}
+
+class PacketQueueWakeupTest : public testing::TestWithParam<PacketQueueMode> {
+protected:
+    void SetUp() override {
+        queue.reset(new NextPacketQueue(0, GetParam(), 4));
+        PacketQueueWaterMark mark;
+        mark.high_packets = 4;
+        queue->SetWaterMark(mark);
+    }
+
+    void Fill() {
+        for (int i = 0; i < 4; i++) {
+            std::unique_ptr<NextPacket> pkt(new NextPacket());
+            ASSERT_EQ(queue->PutPacket(pkt), RESULT_OK);
+        }
+        ASSERT_TRUE(queue->IsFull());
+    }
+
+    std::unique_ptr<NextPacketQueue> queue;
+};
+
+TEST_P(PacketQueueWakeupTest, AbortWakesConsumer) {
+    int ret = 0;
+    int64_t latency = WakeupLatency([&] {
+        std::unique_ptr<NextPacket> pkt;
+        ret = queue->GetPacket(pkt, true);
+    }, [&] { queue->Abort(); });
+    EXPECT_LT(latency, WAKEUP_LIMIT_MS);
+    EXPECT_EQ(ret, ERROR_PLAYER_ABORT);
+}
+
+TEST_P(PacketQueueWakeupTest, FlushWakesConsumer) {
+    int ret = 0;
+    int64_t latency = WakeupLatency([&] {
+        std::unique_ptr<NextPacket> pkt;
+        ret = queue->GetPacket(pkt, true);
+    }, [&] { queue->Flush(); });
+    EXPECT_LT(latency, WAKEUP_LIMIT_MS);
+    EXPECT_EQ(ret, ERROR_PLAYER_TRY_AGAIN);
+    queue->Abort();
+}
+
+// seek: SPSC flushes lazily, the slots free up on the next get of the consumer
+TEST_P(PacketQueueWakeupTest, FlushWakesProducer) {
+    Fill();
+    queue->Flush();
+    int ret = 0;
+    int64_t latency = WakeupLatency([&] {
+        std::unique_ptr<NextPacket> pkt(new NextPacket());
+        ret = queue->PutPacket(pkt, -1);
+    }, [&] {
+        std::unique_ptr<NextPacket> pkt;
+        queue->GetPacket(pkt, false);
+    });
+    EXPECT_LT(latency, WAKEUP_LIMIT_MS);
+    EXPECT_EQ(ret, RESULT_OK);
+    queue->Abort();
+}
+
+TEST_P(PacketQueueWakeupTest, AbortWakesProducer) {
+    Fill();
+    int ret = 0;
+    int64_t latency = WakeupLatency([&] {
+        std::unique_ptr<NextPacket> pkt(new NextPacket());
+        ret = queue->PutPacket(pkt, -1);
+    }, [&] { queue->Abort(); });
+    EXPECT_LT(latency, WAKEUP_LIMIT_MS);
+    EXPECT_EQ(ret, ERROR_PLAYER_ABORT);
+}
+
+// a lost wakeup of the full queue shows up as a put timing out
+TEST_P(PacketQueueWakeupTest, NoLostWakeupWhenFull) {
+    const int count = 20000;
+    std::thread producer([&] {
+        for (int i = 0; i < count; i++) {
+            std::unique_ptr<NextPacket> pkt(new NextPacket());
+            ASSERT_EQ(queue->PutPacket(pkt, 2000), RESULT_OK) << "packet " << i;
+        }
+    });
+    int received = 0;
+    while (received < count) {
+        std::unique_ptr<NextPacket> pkt;
+        int ret = queue->GetPacket(pkt, true);
+        if (ret == ERROR_PLAYER_ABORT) {
+            break;
+        }
+        if (ret == RESULT_OK) {
+            received++;
+        }
+    }
+    producer.join();
+    EXPECT_EQ(received, count);
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, PacketQueueWakeupTest,
+                         testing::Values(PKT_QUEUE_MODE_LOCKED, PKT_QUEUE_MODE_SPSC));
+
+TEST(FrameQueueWakeupTest, AbortWakesReader) {
+    FrameQueue queue(3);
+    FrameBuffer unused;
+    FrameBuffer *frame = &unused;
+    int64_t latency = WakeupLatency([&] { frame = queue.PeekReadable(); },
+                                    [&] { queue.Abort(); });
+    EXPECT_LT(latency, WAKEUP_LIMIT_MS);
+    EXPECT_EQ(frame, nullptr);
+}
+
+TEST(FrameQueueWakeupTest, FlushWakesWriter) {
+    FrameQueue queue(3);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_NE(queue.PeekWritable(), nullptr);
+        queue.Push();
+    }
+    // nothing shown yet, the flush drops every frame and frees the slots
+    FrameBuffer *frame = nullptr;
+    int64_t latency = WakeupLatency([&] { frame = queue.PeekWritable(); },
+                                    [&] { queue.Flush(); });
+    EXPECT_LT(latency, WAKEUP_LIMIT_MS);
+    EXPECT_NE(frame, nullptr);
+    queue.Abort();
+}
@@ -0,0 +1,109 @@
+/**
+ * Note: tests of the read-ahead io layer
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "ReadAheadIO.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavutil/mem.h"
+#ifdef __cplusplus
+}
+#endif
+
+#define SOURCE_SIZE (8 * 1024 * 1024)
+
+// seekable source in memory, seeks fail while bFailSeek is set
+struct MemorySource {
+    std::vector<uint8_t> data;
+    int64_t pos = 0;
+    bool bFailSeek = false;
+    AVIOContext *ctx = nullptr;
+
+    MemorySource() : data(SOURCE_SIZE) {
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = static_cast<uint8_t>(i % 251);
+        }
+        auto *buffer = static_cast<uint8_t *>(av_malloc(4096));
+        ctx = avio_alloc_context(buffer, 4096, 0, this, Read, nullptr, Seek);
+        ctx->seekable = AVIO_SEEKABLE_NORMAL;
+    }
+
+    ~MemorySource() {
+        av_freep(&ctx->buffer);
+        avio_context_free(&ctx);
+    }
+
+    static int Read(void *opaque, uint8_t *buf, int size) {
+        auto *src = static_cast<MemorySource *>(opaque);
+        int64_t left = static_cast<int64_t>(src->data.size()) - src->pos;
+        if (left <= 0) {
+            return AVERROR_EOF;
+        }
+        int len = static_cast<int>(std::min((int64_t) size, left));
+        memcpy(buf, src->data.data() + src->pos, len);
+        src->pos += len;
+        return len;
+    }
+
+    static int64_t Seek(void *opaque, int64_t offset, int whence) {
+        auto *src = static_cast<MemorySource *>(opaque);
+        if (whence == AVSEEK_SIZE) {
+            return static_cast<int64_t>(src->data.size());
+        }
+        if (src->bFailSeek || whence != SEEK_SET) {
+            return AVERROR(EIO);
+        }
+        src->pos = offset;
+        return offset;
+    }
+};
+
+static bool ReadAndCheck(AVIOContext *pb, int64_t pos, int size) {
+    std::vector<uint8_t> buf(size);
+    if (avio_read(pb, buf.data(), size) != size) {
+        return false;
+    }
+    for (int i = 0; i < size; i++) {
+        if (buf[i] != static_cast<uint8_t>((pos + i) % 251)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(ReadAheadIOTest, SeekInsideBuffer) {
+    MemorySource source;
+    ReadAheadIO io;
+    ASSERT_EQ(io.Open(source.ctx, READ_AHEAD_MIN_SIZE), 0);
+    AVIOContext *pb = io.GetContext();
+    ASSERT_TRUE(ReadAndCheck(pb, 0, 512 * 1024));
+    // backward inside the retained range
+    ASSERT_EQ(avio_seek(pb, 100 * 1024, SEEK_SET), 100 * 1024);
+    EXPECT_TRUE(ReadAndCheck(pb, 100 * 1024, 64 * 1024));
+    io.Close();
+}
+
+TEST(ReadAheadIOTest, FailedSeekKeepsReading) {
+    MemorySource source;
+    ReadAheadIO io;
+    ASSERT_EQ(io.Open(source.ctx, READ_AHEAD_MIN_SIZE), 0);
+    AVIOContext *pb = io.GetContext();
+    ASSERT_TRUE(ReadAndCheck(pb, 0, 256 * 1024));
+
+    source.bFailSeek = true;
+    EXPECT_LT(avio_seek(pb, 6 * 1024 * 1024, SEEK_SET), 0);
+    // the buffered data and the read position survive the failure
+    EXPECT_TRUE(ReadAndCheck(pb, 256 * 1024, 3 * 1024 * 1024));
+
+    source.bFailSeek = false;
+    ASSERT_EQ(avio_seek(pb, 6 * 1024 * 1024, SEEK_SET), 6 * 1024 * 1024);
+    EXPECT_TRUE(ReadAndCheck(pb, 6 * 1024 * 1024, 1024 * 1024));
+    io.Close();
+}
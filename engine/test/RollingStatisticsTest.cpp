@@ -0,0 +1,45 @@
+/**
+ * Note: tests of the rolling statistics
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include "CommonUtil.h"
+#include "RollingStatistics.h"
+
+// the read side expires against the steady clock, samples end now
+TEST(RollingStatisticsTest, WindowHoldsHighRate) {
+    RollingStatistics stat;
+    int64_t now = SteadyTimeMs();
+    // 4.9s of 240fps, twice the rate the ring starts with
+    for (int i = 0; i < 1176; i++) {
+        stat.Add(i < 10 ? 1.0 : 2.0, now - 4900 + i * 1000 / 240);
+    }
+    EXPECT_EQ(stat.Count(), 1176);
+    EXPECT_EQ(stat.Percentile(0), 1.0);
+    EXPECT_EQ(stat.Percentile(100), 2.0);
+}
+
+TEST(RollingStatisticsTest, ExpiresByTime) {
+    RollingStatistics stat(1000);
+    int64_t now = SteadyTimeMs();
+    stat.Add(5.0, now - 1500);
+    stat.Add(1.0, now - 500);
+    stat.Add(3.0, now);
+    // the first sample left the window
+    EXPECT_EQ(stat.Count(), 2);
+    EXPECT_EQ(stat.Percentile(0), 1.0);
+    EXPECT_EQ(stat.Percentile(100), 3.0);
+}
+
+TEST(RollingStatisticsTest, DropsOldestAtCap) {
+    RollingStatistics stat(1000000);
+    int64_t now = SteadyTimeMs();
+    for (int i = 0; i <= MAX_STAT_CAPACITY; i++) {
+        stat.Add(static_cast<double>(i), now - MAX_STAT_CAPACITY + i);
+    }
+    EXPECT_EQ(stat.Count(), MAX_STAT_CAPACITY);
+    EXPECT_EQ(stat.Percentile(0), 1.0);
+    EXPECT_EQ(stat.Percentile(100), static_cast<double>(MAX_STAT_CAPACITY));
+}
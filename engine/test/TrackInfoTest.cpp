@@ -0,0 +1,52 @@
+/**
+ * Note: tests of the extradata shared between copies of TrackInfo
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "NextStructDefine.h"
+
+static const uint8_t kExtra[] = {0x01, 0x64, 0x00, 0x1f, 0xff};
+
+TEST(TrackInfoTest, EmptyExtraDataIsNull) {
+    EXPECT_EQ(MakeExtraData(nullptr, 5), nullptr);
+    EXPECT_EQ(MakeExtraData(kExtra, 0), nullptr);
+}
+
+TEST(TrackInfoTest, CopiesShareExtraData) {
+    TrackInfo info;
+    info.extra_data = MakeExtraData(kExtra, sizeof(kExtra));
+    ASSERT_NE(info.extra_data, nullptr);
+    const uint8_t *bytes = info.extra_data->data();
+
+    // demux -> MetaData -> decoder, each a copy by value
+    MetaData meta;
+    meta.track_info.push_back(info);
+    TrackInfo decoder = meta.track_info[0];
+    MetaData copy = meta;
+
+    EXPECT_EQ(info.extra_data.use_count(), 4);
+    EXPECT_EQ(decoder.extra_data->data(), bytes);
+    EXPECT_EQ(copy.track_info[0].extra_data->data(), bytes);
+    EXPECT_EQ(std::vector<uint8_t>(bytes, bytes + sizeof(kExtra)),
+              std::vector<uint8_t>(kExtra, kExtra + sizeof(kExtra)));
+}
+
+TEST(TrackInfoTest, LastCopyFreesExtraData) {
+    std::weak_ptr<const std::vector<uint8_t>> weak;
+    {
+        MetaData meta;
+        TrackInfo info;
+        info.extra_data = MakeExtraData(kExtra, sizeof(kExtra));
+        weak = info.extra_data;
+        meta.track_info.push_back(info);
+        TrackInfo moved = std::move(info);
+        MetaData copy = meta;
+        copy = MetaData();
+        EXPECT_EQ(weak.use_count(), 2);
+    }
+    EXPECT_TRUE(weak.expired());
+}
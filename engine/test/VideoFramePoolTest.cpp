@@ -0,0 +1,129 @@
+/**
+ * Note: tests of the recycle pool of decoded video frames
+ * Date: 2026/10/18
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "decode/VideoFramePool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "libavformat/avformat.h"
+#ifdef __cplusplus
+}
+#endif
+
+static void ReleaseAll(std::vector<FFmpegBufferContext *> &frames) {
+    for (auto *context : frames) {
+        context->release_frame(context);
+    }
+    frames.clear();
+}
+
+// steady state: after the first round every frame shell comes from the pool
+TEST(VideoFramePoolTest, ShellsRecycled) {
+    VideoFramePool *pool = VideoFramePool::Create(8);
+    std::vector<FFmpegBufferContext *> frames;
+    for (int round = 0; round < 100; round++) {
+        for (int i = 0; i < 8; i++) {
+            FFmpegBufferContext *context = pool->Obtain();
+            ASSERT_NE(context, nullptr);
+            ASSERT_NE(context->av_frame, nullptr);
+            frames.push_back(context);
+        }
+        ReleaseAll(frames);
+    }
+    FramePoolStat stat = pool->GetStat();
+    EXPECT_EQ(stat.obtain_count, 800);
+    EXPECT_EQ(stat.obtain_count - stat.hit_count, 8);
+    EXPECT_EQ(stat.peak_in_use, 8);
+    pool->Release();
+}
+
+TEST(VideoFramePoolTest, KeepsAtMostMaxSize) {
+    VideoFramePool *pool = VideoFramePool::Create(2);
+    std::vector<FFmpegBufferContext *> frames;
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 4; i++) {
+            frames.push_back(pool->Obtain());
+        }
+        ReleaseAll(frames);
+    }
+    FramePoolStat stat = pool->GetStat();
+    EXPECT_EQ(stat.hit_count, 2);
+    EXPECT_EQ(stat.peak_in_use, 4);
+    pool->Release();
+}
+
+// the renderer lets go of its frames after the decoder is released
+TEST(VideoFramePoolTest, FramesOutliveRelease) {
+    VideoFramePool *pool = VideoFramePool::Create();
+    std::vector<FFmpegBufferContext *> frames;
+    for (int i = 0; i < 3; i++) {
+        frames.push_back(pool->Obtain());
+    }
+    frames.back()->release_frame(frames.back());
+    frames.pop_back();
+    pool->Release();
+    // the last release deletes the pool
+    ReleaseAll(frames);
+}
+
+// planes of a real decode, NEXT_TEST_VIDEO names a file with a video stream
+TEST(VideoFramePoolTest, PlanesRecycledWhileDecoding) {
+    const char *path = getenv("NEXT_TEST_VIDEO");
+    if (!path) {
+        GTEST_SKIP() << "NEXT_TEST_VIDEO not set";
+    }
+    AVFormatContext *fmt = nullptr;
+    ASSERT_GE(avformat_open_input(&fmt, path, nullptr, nullptr), 0);
+    ASSERT_GE(avformat_find_stream_info(fmt, nullptr), 0);
+    int index = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    ASSERT_GE(index, 0);
+
+    const AVCodec *codec = avcodec_find_decoder(fmt->streams[index]->codecpar->codec_id);
+    ASSERT_NE(codec, nullptr);
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(ctx, fmt->streams[index]->codecpar);
+    VideoFramePool *pool = VideoFramePool::Create();
+    pool->Attach(ctx);
+    ASSERT_GE(avcodec_open2(ctx, codec, nullptr), 0);
+
+    AVPacket *pkt = av_packet_alloc();
+    bool eof = false;
+    while (!eof) {
+        eof = av_read_frame(fmt, pkt) < 0;
+        if (!eof && pkt->stream_index != index) {
+            av_packet_unref(pkt);
+            continue;
+        }
+        avcodec_send_packet(ctx, eof ? nullptr : pkt);
+        av_packet_unref(pkt);
+        FFmpegBufferContext *context;
+        while ((context = pool->Obtain())
+               && avcodec_receive_frame(ctx, reinterpret_cast<AVFrame *>(context->av_frame)) >= 0) {
+            context->release_frame(context);
+        }
+        if (context) {
+            context->release_frame(context);
+        }
+    }
+    av_packet_free(&pkt);
+    avcodec_free_context(&ctx);
+    avformat_close_input(&fmt);
+
+    FramePoolStat stat = pool->GetStat();
+    pool->Release();
+    if (stat.fallback_count > 0) {
+        GTEST_SKIP() << "the codec does not decode into the pool";
+    }
+    ASSERT_GT(stat.get_buffer_count, 0);
+    // the planes of the frames the codec holds at once, then no more heap
+    EXPECT_LE(stat.plane_alloc_count, FRAME_POOL_MAX_PLANES * 32);
+    EXPECT_LE(stat.obtain_count - stat.hit_count, 2);
+}